@@ -0,0 +1,74 @@
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+#include "trt_segmentation.h"
+#include "bench_util.h"
+
+// 引擎加载基准：测量 init_engine (内存映射) 与旧的 "整个文件读入 vector 再反序列化" 方式
+// 的启动时间和峰值内存。峰值 RSS 是进程级的，因此每种方式需要单独运行一次进程。
+//
+// 用法: trt_seg_load_bench <engine_path> [mmap|memory] [num_contexts]
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <engine_path> [mmap|memory] [num_contexts]" << std::endl;
+        return -1;
+    }
+    const char* engine_path = argv[1];
+    const char* mode = argc > 2 ? argv[2] : "mmap";
+    const int num_contexts = argc > 3 ? std::atoi(argv[3]) : 1;
+    if (std::strcmp(mode, "mmap") != 0 && std::strcmp(mode, "memory") != 0) {
+        std::cerr << "Unknown mode: " << mode << std::endl;
+        return -1;
+    }
+
+    TRT_SEG_HANDLE handle = create_segmentation_instance();
+    if (!handle || set_context_pool_size(handle, num_contexts) != 0) {
+        std::cerr << "Failed to create segmentation instance." << std::endl;
+        return -1;
+    }
+
+    const size_t rss_before = current_rss_bytes();
+    const double start = now_ms();
+    double read_ms = 0.0;
+    int result = 0;
+
+    if (std::strcmp(mode, "mmap") == 0) {
+        result = init_engine(handle, engine_path);
+    } else {
+        std::ifstream file(engine_path, std::ios::binary | std::ios::ate);
+        if (!file.is_open()) {
+            std::cerr << "Could not open engine file: " << engine_path << std::endl;
+            destroy_segmentation_instance(handle);
+            return -1;
+        }
+        std::vector<char> data(static_cast<size_t>(file.tellg()));
+        file.seekg(0);
+        file.read(data.data(), static_cast<std::streamsize>(data.size()));
+        read_ms = now_ms() - start;
+        result = init_engine_from_memory(handle, data.data(), data.size());
+    }
+
+    const double total_ms = now_ms() - start;
+    if (result != 0) {
+        std::cerr << "Failed to initialize engine." << std::endl;
+        destroy_segmentation_instance(handle);
+        return -1;
+    }
+
+    std::cout << "mode:            " << mode << std::endl;
+    std::cout << "contexts:        " << num_contexts << std::endl;
+    if (read_ms > 0.0) {
+        std::cout << "file read:       " << read_ms << " ms" << std::endl;
+    }
+    std::cout << "init total:      " << total_ms << " ms" << std::endl;
+    std::cout << "rss before init: " << to_mib(rss_before) << " MiB" << std::endl;
+    std::cout << "rss after init:  " << to_mib(current_rss_bytes()) << " MiB" << std::endl;
+    std::cout << "peak rss:        " << to_mib(peak_rss_bytes()) << " MiB" << std::endl;
+
+    destroy_segmentation_instance(handle);
+    return 0;
+}
@@ -0,0 +1,248 @@
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <opencv2/opencv.hpp>
+
+#include "trt_segmentation.h"
+#include "bench_util.h"
+
+// 端到端的主机侧基准：默认使用 null 后端 (合成 logits，推理耗时为 0)，
+// 因此测得的就是预处理、调度、后处理、缩放以及 (file 模式下) 图像编解码和文件读写的开销。
+// 也可以通过 --backend/--model 换成真实的模型做对比。
+//
+// 用法: trt_seg_bench [--width 8192] [--height 1024] [--classes 2] [--threads 1] [--batch 1]
+//                      [--delay-us 500] [--requests 200] [--warmup 10] [--mode buffer|file]
+//                      [--backend null|tensorrt|opencv] [--model path] [--trace trace.json]
+//                      [--perf 1] [--tile-overlap 64]
+
+namespace {
+
+struct Options {
+    int width = 8192;
+    int height = 1024;
+    int classes = 2;
+    int threads = 1;
+    int batch = 1;
+    int delay_us = 500;
+    int requests = 200;
+    int warmup = 10;
+    std::string mode = "buffer";
+    std::string backend = "null";
+    std::string model;
+    std::string trace; // 非空时记录计时阶段的 span 并导出到该文件
+    bool perf = false;  // 各阶段的硬件计数器 (Linux perf_event)
+    int tile_overlap = -1; // >= 0 时开启分块推理
+};
+
+bool parse_options(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        const std::string key = argv[i];
+        if (i + 1 >= argc) return false;
+        const char* value = argv[++i];
+        if (key == "--width") options.width = std::atoi(value);
+        else if (key == "--height") options.height = std::atoi(value);
+        else if (key == "--classes") options.classes = std::atoi(value);
+        else if (key == "--threads") options.threads = std::atoi(value);
+        else if (key == "--batch") options.batch = std::atoi(value);
+        else if (key == "--delay-us") options.delay_us = std::atoi(value);
+        else if (key == "--requests") options.requests = std::atoi(value);
+        else if (key == "--warmup") options.warmup = std::atoi(value);
+        else if (key == "--mode") options.mode = value;
+        else if (key == "--backend") options.backend = value;
+        else if (key == "--model") options.model = value;
+        else if (key == "--trace") options.trace = value;
+        else if (key == "--perf") options.perf = std::atoi(value) != 0;
+        else if (key == "--tile-overlap") options.tile_overlap = std::atoi(value);
+        else return false;
+    }
+    return options.width > 0 && options.height > 0 && options.classes > 0 && options.threads > 0 &&
+           options.batch > 0 && options.requests > 0 && options.warmup >= 0 &&
+           (options.mode == "buffer" || options.mode == "file");
+}
+
+// 确定性的合成条带图像：斜向渐变加上每张图不同的相位
+cv::Mat make_strip(int width, int height, int seed) {
+    cv::Mat image(height, width, CV_8UC3);
+    for (int y = 0; y < height; ++y) {
+        uint8_t* row = image.ptr(y);
+        for (int x = 0; x < width; ++x) {
+            row[3 * x + 0] = static_cast<uint8_t>(x * 7 + y * 3 + seed * 31);
+            row[3 * x + 1] = static_cast<uint8_t>(x * 5 + y * 11 + seed * 17);
+            row[3 * x + 2] = static_cast<uint8_t>((x ^ y) + seed * 13);
+        }
+    }
+    return image;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parse_options(argc, argv, options)) {
+        std::cerr << "Usage: " << argv[0] << " [--width W] [--height H] [--classes C] [--threads T] [--batch B]"
+                  << " [--delay-us D] [--requests N] [--warmup N] [--mode buffer|file]"
+                  << " [--backend null|tensorrt|opencv] [--model path] [--trace path] [--perf 0|1] [--tile-overlap N]" << std::endl;
+        return -1;
+    }
+
+    int backend = TRT_SEG_BACKEND_NULL;
+    std::string model = options.model;
+    if (options.backend == "tensorrt") {
+        backend = TRT_SEG_BACKEND_TENSORRT;
+    } else if (options.backend == "opencv") {
+        backend = TRT_SEG_BACKEND_OPENCV_CPU;
+    } else if (options.backend == "null") {
+        if (model.empty()) {
+            model = "classes=" + std::to_string(options.classes) + ",max_batch=" + std::to_string(options.batch);
+        }
+    } else {
+        std::cerr << "Unknown backend: " << options.backend << std::endl;
+        return -1;
+    }
+
+    TRT_SEG_HANDLE handle = create_segmentation_instance();
+    if (!handle || set_backend(handle, backend) != 0 || set_context_pool_size(handle, options.threads) != 0 ||
+        init_engine(handle, model.c_str()) != 0) {
+        std::cerr << "Failed to initialize backend." << std::endl;
+        destroy_segmentation_instance(handle);
+        return -1;
+    }
+    if (options.tile_overlap >= 0 && set_tiling(handle, 1, options.tile_overlap) != 0) {
+        std::cerr << "Failed to enable tiling." << std::endl;
+        destroy_segmentation_instance(handle);
+        return -1;
+    }
+    if (options.batch > 1 && set_dynamic_batching(handle, options.batch, options.delay_us) != 0) {
+        std::cerr << "Failed to enable dynamic batching." << std::endl;
+        destroy_segmentation_instance(handle);
+        return -1;
+    }
+
+    // A few distinct images so that caches do not flatter the file mode
+    const int num_images = 4;
+    std::vector<cv::Mat> images;
+    for (int i = 0; i < num_images; ++i) images.push_back(make_strip(options.width, options.height, i));
+
+    const std::filesystem::path work_dir =
+        std::filesystem::temp_directory_path() / ("trt_seg_bench_" + std::to_string(static_cast<long long>(now_ms())));
+    std::vector<std::string> inputs;
+    if (options.mode == "file") {
+        std::filesystem::create_directories(work_dir);
+        for (int i = 0; i < num_images; ++i) {
+            inputs.push_back((work_dir / ("strip_" + std::to_string(i) + ".png")).string());
+            cv::imwrite(inputs.back(), images[i]);
+        }
+    }
+
+    // 每个线程一个输出缓冲区 (buffer 模式) 或一组输出文件 (file 模式)
+    auto run_one = [&](int thread, int request, std::vector<uint8_t>& mask) {
+        const int image = request % num_images;
+        if (options.mode == "file") {
+            const std::string output = (work_dir / ("mask_" + std::to_string(thread) + ".png")).string();
+            return run_inference(handle, inputs[image].c_str(), output.c_str());
+        }
+        const cv::Mat& src = images[image];
+        return run_inference_buffer(handle, src.data, src.cols, src.rows, static_cast<int>(src.step), TRT_SEG_PIXEL_BGR8,
+                                    mask.data(), src.cols);
+    };
+
+    // Warm up buffer pools, preprocessing tables and the OpenCV thread pool outside the timed run
+    std::vector<uint8_t> warmup_mask(static_cast<size_t>(options.width) * options.height);
+    for (int i = 0; i < options.warmup; ++i) run_one(0, i, warmup_mask);
+    if (options.perf && enable_perf_counters(handle, 1) != 0) {
+        std::cerr << "Error: Failed to enable hardware counters; continuing without them." << std::endl;
+        options.perf = false;
+    }
+    reset_inference_stats(handle);
+    if (!options.trace.empty() && enable_tracing(handle, 1 << 16, nullptr) != 0) {
+        std::cerr << "Error: Failed to enable tracing." << std::endl;
+    }
+
+    std::atomic<int> next_request{0};
+    std::atomic<int> failures{0};
+    std::vector<std::vector<double>> latencies(options.threads);
+
+    const double start = now_ms();
+    std::vector<std::thread> workers;
+    for (int t = 0; t < options.threads; ++t) {
+        workers.emplace_back([&, t] {
+            std::vector<uint8_t> mask(static_cast<size_t>(options.width) * options.height);
+            for (int request = next_request++; request < options.requests; request = next_request++) {
+                const double begin = now_ms();
+                if (run_one(t, request, mask) != 0) ++failures;
+                latencies[t].push_back(now_ms() - begin);
+            }
+        });
+    }
+    for (auto& worker : workers) worker.join();
+    const double wall_ms = now_ms() - start;
+
+    std::vector<double> all;
+    for (const auto& samples : latencies) all.insert(all.end(), samples.begin(), samples.end());
+    std::sort(all.begin(), all.end());
+    double sum = 0.0;
+    for (double v : all) sum += v;
+
+    const double seconds = wall_ms / 1000.0;
+    const double throughput = options.requests / seconds;
+    const double megapixels = throughput * options.width * options.height / 1e6;
+
+    std::cout << "backend:     " << options.backend << " (" << options.mode << " mode)" << std::endl;
+    std::cout << "image:       " << options.width << "x" << options.height << ", " << options.classes << " classes" << std::endl;
+    std::cout << "threads:     " << options.threads << ", batch " << options.batch << std::endl;
+    std::cout << "requests:    " << options.requests << " (+" << options.warmup << " warmup), " << failures.load() << " failed" << std::endl;
+    std::cout << "throughput:  " << throughput << " img/s, " << megapixels << " MPix/s" << std::endl;
+    std::cout << "latency ms:  mean " << (all.empty() ? 0.0 : sum / all.size())
+              << "  p50 " << percentile(all, 0.50) << "  p90 " << percentile(all, 0.90)
+              << "  p99 " << percentile(all, 0.99) << "  p99.9 " << percentile(all, 0.999) << std::endl;
+
+    // Per-stage breakdown from the library's own histograms
+    static const char* stage_names[TRT_SEG_NUM_STAGES] = {"decode", "preprocess", "h2d", "execute", "d2h",
+                                                           "postprocess", "upscale", "encode", "total"};
+    TRT_SEG_INFERENCE_STATS stats;
+    if (get_inference_stats(handle, &stats) == 0) {
+        std::cout << "stage us:    count / mean / p50 / p99 / p99.9" << std::endl;
+        for (int i = 0; i < TRT_SEG_NUM_STAGES; ++i) {
+            const TRT_SEG_STAGE_STATS& stage = stats.stages[i];
+            if (stage.count == 0) continue;
+            std::cout << "  " << stage_names[i] << ": " << stage.count << " / " << stage.mean_us << " / " << stage.p50_us
+                      << " / " << stage.p99_us << " / " << stage.p999_us << std::endl;
+        }
+    }
+
+    TRT_SEG_PERF_COUNTERS perf;
+    if (options.perf && get_perf_counters(handle, &perf) == 0) {
+        // Per stage invocation, summed over the OpenCV workers of parallel preprocess/postprocess;
+        // IPC well below 1 with many LLC misses points at memory-bound code
+        std::cout << "stage perf:  IPC / Mcycles / LLC misses / branch misses (per call, all threads)" << std::endl;
+        for (int i = 0; i < TRT_SEG_NUM_STAGES; ++i) {
+            const TRT_SEG_STAGE_PERF& stage = perf.stages[i];
+            if (stage.count == 0) continue;
+            const double n = static_cast<double>(stage.count);
+            std::cout << "  " << stage_names[i] << ": "
+                      << (stage.cycles ? static_cast<double>(stage.instructions) / stage.cycles : 0.0) << " / "
+                      << stage.cycles / n / 1e6 << " / " << stage.llc_misses / n << " / " << stage.branch_misses / n
+                      << std::endl;
+        }
+    }
+
+    if (!options.trace.empty()) {
+        disable_tracing(handle);
+        if (dump_trace(handle, options.trace.c_str()) == 0) {
+            std::cout << "trace:       " << options.trace << std::endl;
+        }
+    }
+
+    destroy_segmentation_instance(handle);
+    if (options.mode == "file") {
+        std::error_code ec;
+        std::filesystem::remove_all(work_dir, ec);
+    }
+    return failures.load() == 0 ? 0 : 1;
+}
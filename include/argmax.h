@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// argmax 结果的输出形式
+enum class ArgmaxOutput {
+    kLabels,          // 类别索引 (需 num_classes <= 256，推理时会检查；大于 255 的索引在所有实现中都饱和为 255)
+    kForegroundMask,  // 类别 > 0 为 255，否则为 0
+};
+
+// 对 planar 排列的 logits (num_classes 个平面，相邻平面相隔 plane_stride 个元素)
+// 中连续的 count 个像素求类别 argmax，结果写入 out。
+// 相同分值时取最小的类别索引，与逐像素标量实现一致。
+// 实现根据 CPU 在运行时选择 AVX-512 / AVX2 / SSE4.1 / 标量版本。
+void argmax_planar(const float* logits, int num_classes, size_t plane_stride, size_t count,
+                   uint8_t* out, ArgmaxOutput mode);
+
+// 同上，logits 为 IEEE fp16 (按 uint16_t 存储)。每次转换一小段像素到 float 后复用上面的实现，
+// 主机上不需要整张 float 输出
+void argmax_planar_f16(const uint16_t* logits, int num_classes, size_t plane_stride, size_t count,
+                       uint8_t* out, ArgmaxOutput mode);
+
+// fp16 -> float，有 F16C 时使用硬件转换
+void half_to_float(const uint16_t* src, float* dst, size_t count);
+// float -> fp16，就近舍入。
+// 两个方向的标量实现与 F16C 的结果逐位相同，包括 NaN (转为 quiet NaN 并保留载荷的高位)
+void float_to_half(const float* src, uint16_t* dst, size_t count);
+
+// 同 argmax_planar，并在同一遍中计算获胜类别的 softmax 概率 1 / Σ exp(l_c - l_max) 写入 confidence。
+// exp 使用多项式近似 (相对误差 < 1e-5)，远小于 uint8/fp16 量化的误差。AVX-512 / AVX2 / 标量三个版本。
+// 结果限制在 [0, 1]：NaN 的 logit 不计入求和，获胜分值为 NaN 的像素置信度为 0
+void argmax_confidence_planar(const float* logits, int num_classes, size_t plane_stride, size_t count,
+                              uint8_t* out, ArgmaxOutput mode, float* confidence);
+void argmax_confidence_planar_f16(const uint16_t* logits, int num_classes, size_t plane_stride, size_t count,
+                                  uint8_t* out, ArgmaxOutput mode, float* confidence);
+
+// [0, 1] 的概率量化为 0~255 (四舍五入)
+void quantize_unit_u8(const float* src, uint8_t* dst, size_t count);
+
+// 模型已经内置 argmax、直接输出类别索引时使用：不做 argmax，
+// kLabels 为窄化复制 (超出 [0, 255] 的值被截断)，kForegroundMask 为 label > 0 的阈值
+template <typename T>
+void labels_to_output(const T* labels, size_t count, uint8_t* out, ArgmaxOutput mode) {
+    if (mode == ArgmaxOutput::kForegroundMask) {
+        for (size_t i = 0; i < count; ++i) out[i] = labels[i] > 0 ? 255 : 0;
+    } else {
+        for (size_t i = 0; i < count; ++i) {
+            const T v = labels[i];
+            out[i] = static_cast<uint8_t>(v < 0 ? 0 : (v > 255 ? 255 : v));
+        }
+    }
+}
+
+// 当前选用的实现名称，便于日志和基准测试输出
+const char* argmax_isa_name();
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// 动态批处理调度器。
+// 调用方线程通过 run() 提交任务并阻塞等待；工作线程把排队的任务合并成批次，
+// 批次大小达到 max_batch_size，或最早的任务已等待 max_delay 时立即执行。
+// Executor 负责执行整个批次并把结果写回每个任务 (scatter)，
+// 它不依赖任何推理后端，因此可以用 CPU 上的替身执行器单独验证。
+template <typename Job>
+class BatchScheduler {
+public:
+    using Executor = std::function<void(std::vector<Job*>& batch)>;
+
+    BatchScheduler(size_t max_batch_size, std::chrono::microseconds max_delay, size_t num_workers, Executor executor)
+        : max_batch_size_(std::max<size_t>(max_batch_size, 1)), max_delay_(max_delay), executor_(std::move(executor)) {
+        num_workers = std::max<size_t>(num_workers, 1);
+        for (size_t i = 0; i < num_workers; ++i) {
+            this->workers_.emplace_back([this] { this->worker_loop(); });
+        }
+    }
+
+    // 执行完队列中剩余的任务后退出
+    ~BatchScheduler() {
+        {
+            std::lock_guard<std::mutex> lock(this->mutex_);
+            this->stopping_ = true;
+        }
+        this->cv_.notify_all();
+        for (auto& worker : this->workers_) worker.join();
+    }
+
+    BatchScheduler(const BatchScheduler&) = delete;
+    BatchScheduler& operator=(const BatchScheduler&) = delete;
+
+    // 提交任务并阻塞，直到它所在的批次执行完毕
+    void run(Job& job) {
+        Pending pending;
+        pending.job = &job;
+        pending.enqueued = Clock::now();
+        std::future<void> done = pending.done.get_future();
+        {
+            // Notify under the lock: once it is released the job may already be done and the
+            // scheduler destroyed (the destructor drains the queue), so cv_ must not be touched after it
+            std::lock_guard<std::mutex> lock(this->mutex_);
+            this->queue_.push_back(&pending);
+            this->cv_.notify_one();
+        }
+        done.wait();
+    }
+
+    size_t max_batch_size() const { return this->max_batch_size_; }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Pending {
+        Job* job = nullptr;
+        Clock::time_point enqueued;
+        std::promise<void> done;
+    };
+
+    void worker_loop() {
+        std::vector<Pending*> batch;
+        std::vector<Job*> jobs;
+        std::unique_lock<std::mutex> lock(this->mutex_);
+        while (true) {
+            this->cv_.wait(lock, [this] { return this->stopping_ || !this->queue_.empty(); });
+            if (this->queue_.empty()) return; // stopping and drained
+
+            // 等待批次凑满或最早的任务到期
+            while (!this->stopping_ && !this->queue_.empty() && this->queue_.size() < this->max_batch_size_) {
+                const Clock::time_point deadline = this->queue_.front()->enqueued + this->max_delay_;
+                if (Clock::now() >= deadline) break;
+                this->cv_.wait_until(lock, deadline);
+            }
+            if (this->queue_.empty()) continue; // 被其他工作线程取走
+
+            const size_t n = std::min(this->queue_.size(), this->max_batch_size_);
+            batch.assign(this->queue_.begin(), this->queue_.begin() + n);
+            this->queue_.erase(this->queue_.begin(), this->queue_.begin() + n);
+            // 剩余的任务交给其他空闲的工作线程开始组下一批
+            if (!this->queue_.empty()) this->cv_.notify_one();
+
+            lock.unlock();
+            jobs.clear();
+            for (Pending* p : batch) jobs.push_back(p->job);
+            this->executor_(jobs);
+            for (Pending* p : batch) p->done.set_value();
+            lock.lock();
+        }
+    }
+
+    const size_t max_batch_size_;
+    const std::chrono::microseconds max_delay_;
+    Executor executor_;
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<Pending*> queue_;
+    bool stopping_ = false;
+    std::vector<std::thread> workers_;
+};
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <map>
+#include <string>
+
+#include "tensor_types.h"
+
+// 内存分配器接口：设备内存、锁页主机内存和普通主机内存都通过它分配，
+// 这样 BufferPool 的复用逻辑可以脱离 CUDA 单独验证。
+class IAllocator {
+public:
+    virtual ~IAllocator() = default;
+    // 失败时返回 nullptr
+    virtual void* allocate(size_t bytes) = 0;
+    virtual void deallocate(void* ptr) = 0;
+};
+
+// 64 字节对齐的普通主机内存
+class HostAllocator : public IAllocator {
+public:
+    void* allocate(size_t bytes) override;
+    void deallocate(void* ptr) override;
+};
+
+struct BufferPoolStats {
+    size_t allocations = 0;       // 实际调用 allocate 的次数
+    size_t reuses = 0;            // 直接复用已有缓冲区的次数
+    size_t reserved_bytes = 0;    // 当前持有的总字节数
+    size_t peak_reserved_bytes = 0; // reserved_bytes 的历史最大值
+    size_t peak_request_bytes = 0;  // 单次请求的最大字节数
+};
+
+// 把 s 合并到 total：计数和字节数相加，peak_request_bytes 取最大值。
+// 各个池的峰值不一定同时出现，相加后的 peak_reserved_bytes 是上界
+void accumulate(BufferPoolStats& total, const BufferPoolStats& s);
+
+// 按张量名缓存的缓冲区池，只增不减。
+// 键只有张量名：形状和数据类型只用来计算所需字节数，不超过已有容量时直接复用 (即使形状或类型变了)，
+// 只有更大的请求到来时才释放并重新分配，从不缩小。缓冲区内容在重新分配时不保留。
+// 不是线程安全的：每个 InferenceSlot 拥有自己的池；统计计数器可以从其他线程读取。
+class BufferPool {
+public:
+    explicit BufferPool(IAllocator& allocator) : allocator_(allocator) {}
+    ~BufferPool();
+
+    BufferPool(const BufferPool&) = delete;
+    BufferPool& operator=(const BufferPool&) = delete;
+
+    // 返回至少能容纳 shape x dtype 的缓冲区，分配失败时返回 nullptr
+    void* acquire(const std::string& tensor, const TensorShape& shape, TensorDataType dtype);
+
+    // 释放所有缓冲区 (计数器保留)
+    void release_all();
+
+    BufferPoolStats stats() const;
+
+private:
+    struct Entry {
+        void* ptr = nullptr;
+        size_t capacity = 0;
+    };
+
+    IAllocator& allocator_;
+    std::map<std::string, Entry> entries_;
+
+    std::atomic<size_t> allocations_{0};
+    std::atomic<size_t> reuses_{0};
+    std::atomic<size_t> reserved_bytes_{0};
+    std::atomic<size_t> peak_reserved_bytes_{0};
+    std::atomic<size_t> peak_request_bytes_{0};
+};
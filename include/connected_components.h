@@ -0,0 +1,87 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+// 一个连通域 (8 邻域) 在目标分辨率上的统计
+struct ComponentStats {
+    int class_id = 0;         // 连通域在输出中的像素值：标签图为类别索引，前景掩码为 255
+    int64_t area = 0;         // 像素数
+    int x = 0, y = 0;         // 外接矩形左上角
+    int width = 0, height = 0;
+    double centroid_x = 0.0;  // 质心
+    double centroid_y = 0.0;
+};
+
+// 请求连通域统计时交给后处理；面积小于 min_area 的连通域被丢弃
+struct ComponentSet {
+    int64_t min_area = 0;
+    std::vector<ComponentStats> items; // 按外接矩形的 (y, x) 排序
+};
+
+// 目标列与模型分辨率行缓冲的对应：第 g 个网格列取 line[src[g]]，覆盖目标列 [x0[g], x0[g + 1])。
+// 最近邻缩放后的掩码由这些网格单元放大而成，因此在网格上标记连通域、再按单元覆盖的范围累加统计，
+// 与在放大后的掩码上标记完全一致，而不需要逐个目标像素扫描
+struct ColumnGrid {
+    std::vector<int> src;
+    std::vector<int> x0; // src.size() + 1 项，最后一项为目标宽度
+
+    static ColumnGrid identity(int width);
+    // src_x[x] 为目标列 x 对应的源列 (单调不减)
+    static ColumnGrid from_map(const int* src_x, int dst_width);
+};
+
+// 基于行程的并查集连通域标记，与后处理的 argmax 在同一遍中完成。
+// 后处理按行分段并行：每段通过 begin_chunk 取得自己的 Chunk，按行序调用 add_row，
+// 段内独立标记；finish 把相邻段的边界行合并后得到全局的连通域
+class ComponentLabeller {
+public:
+    class Chunk {
+    public:
+        // line 为一行模型分辨率的输出 (0 为背景)，覆盖目标行 [dy0, dy1)；连续两次调用必须是相邻的网格行
+        void add_row(const uint8_t* line, int dy0, int dy1);
+
+    private:
+        friend class ComponentLabeller;
+
+        struct Run {
+            int g0, g1; // 网格列 [g0, g1)
+            uint8_t value;
+            int label;
+        };
+        struct Accum {
+            uint8_t value = 0;
+            int64_t area = 0;
+            int x_min = 0, x_max = 0, y_min = 0, y_max = 0; // 闭区间
+            double sum_x = 0.0, sum_y = 0.0;
+        };
+
+        Chunk(const ColumnGrid& grid, int first_row) : grid_(grid), first_row_(first_row) {}
+        int find(int label);
+        void unite(int a, int b);
+
+        const ColumnGrid& grid_;
+        const int first_row_; // 分段的起始源行，用于排序
+        bool has_rows_ = false;
+        std::vector<Run> first_, prev_, cur_; // 第一行、上一行、当前行的行程
+        std::vector<int> parent_;
+        std::vector<Accum> accum_;
+    };
+
+    explicit ComponentLabeller(ColumnGrid grid) : grid_(std::move(grid)) {}
+
+    // 线程安全；first_row 为该分段的第一个源行
+    Chunk* begin_chunk(int first_row);
+
+    // 合并各分段并输出面积不小于 min_area 的连通域
+    void finish(int64_t min_area, std::vector<ComponentStats>& out);
+
+private:
+    const ColumnGrid grid_;
+    std::mutex mutex_;
+    std::vector<std::unique_ptr<Chunk>> chunks_;
+};
@@ -0,0 +1,26 @@
+#pragma once
+
+// 运行时 CPU 指令集检测，用于在 SIMD 内核之间分派
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+    #define TRT_SEG_X86 1
+#endif
+
+// GCC/Clang 需要按函数开启目标指令集；MSVC 无需额外标志即可使用内建函数
+#if defined(__GNUC__) || defined(__clang__)
+    #define TRT_SEG_TARGET(isa) __attribute__((target(isa)))
+#else
+    #define TRT_SEG_TARGET(isa)
+#endif
+
+struct CpuFeatures {
+    bool sse41 = false;
+    bool avx2 = false;
+    bool fma = false;
+    bool f16c = false;
+    bool avx512f = false;
+    bool avx512bw = false;
+};
+
+// 首次调用时通过 CPUID/XGETBV 检测，之后返回缓存结果
+const CpuFeatures& cpu_features();
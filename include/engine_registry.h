@@ -0,0 +1,60 @@
+#pragma once
+
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "NvInfer.h"
+#include "NvInferRuntime.h"
+
+
+class Logger : public nvinfer1::ILogger {
+    void log(Severity severity, const char* msg) noexcept override {
+        // if (severity <= Severity::kWARNING) {
+        //     std::cout << msg << std::endl;
+        // }
+    }
+};
+
+// 一个反序列化后的引擎及创建它的 runtime，可以被多个句柄共享。
+// 各句柄只创建自己的执行上下文。
+struct SharedEngine {
+    ~SharedEngine();
+
+    Logger logger;
+    std::unique_ptr<nvinfer1::IRuntime> runtime;
+    std::unique_ptr<nvinfer1::ICudaEngine> engine;
+
+    // 串行化不同句柄在同一个引擎上创建执行上下文
+    std::mutex context_mutex;
+};
+
+// 从内存反序列化一个新的引擎 (不经过缓存)，失败时返回 nullptr
+std::shared_ptr<SharedEngine> load_engine(const void* engine_data, size_t engine_size);
+
+// 进程级的引擎缓存。
+// 键为规范化路径 + 已打开文件的标识 (设备/inode、大小、修改时间)，文件被替换后会重新加载。
+// 只保存 weak_ptr：最后一个使用者释放后引擎随之销毁。
+// 反序列化在锁外进行：同一个键的并发请求等待第一个加载完成，不同模型之间互不阻塞。
+class EngineRegistry {
+public:
+    static EngineRegistry& instance();
+
+    // 返回已缓存的引擎，或者映射文件并反序列化一个新的，失败时返回 nullptr
+    std::shared_ptr<SharedEngine> acquire(const std::string& engine_path);
+
+private:
+    EngineRegistry() = default;
+
+    struct Entry {
+        std::shared_future<void> loaded;     // 加载线程完成 (无论成功与否) 后就绪
+        bool done = false;                   // 以下字段由 mutex_ 保护
+        bool failed = false;
+        std::weak_ptr<SharedEngine> engine;
+    };
+
+    std::mutex mutex_;
+    std::map<std::string, std::shared_ptr<Entry>> entries_;
+};
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include <opencv2/opencv.hpp>
+
+// 解码后的 BGR 图像。以缩小的分辨率解码时 pixels 小于原始图像，掩码仍按 width x height 输出
+struct DecodedImage {
+    cv::Mat pixels;
+    int width = 0;  // 原始图像的尺寸
+    int height = 0;
+};
+
+// 从 JPEG 的 SOF 段读取尺寸而不解码；不是 JPEG 或头部不完整时返回 false。
+// 返回的是编码尺寸，EXIF 方向旋转之前
+bool jpeg_dimensions(const uint8_t* data, size_t size, int& width, int& height);
+
+// JPEG 可以在 DCT 阶段直接缩小 1/2、1/4 或 1/8 解码 (libjpeg 的 scale_denom，输出为 ceil(尺寸 / denom))。
+// 返回使两个方向都不小于 min_width x min_height 的最大分母，不能缩小时为 1
+int reduced_decode_denominator(int width, int height, int min_width, int min_height);
+
+// 解码内存中的编码图像 (cv::imdecode，按 EXIF 方向旋转)；denominator 为 2/4/8 时对 JPEG 做 DCT 缩放解码。
+// 失败时 pixels 为空
+void decode_image(const uint8_t* data, size_t size, int denominator, DecodedImage& out);
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+#include "buffer_pool.h"
+#include "inference_stats.h"
+#include "tensor_types.h"
+
+// 推理后端的种类，顺序与 trt_segmentation.h 中的 TRT_SEG_BACKEND 一致
+enum class BackendKind {
+    kTensorRT = 0,  // .engine 文件，GPU 推理
+    kOpenCV = 1,    // .onnx 文件，OpenCV DNN 在 CPU 上推理
+    kNull = 2,      // 不加载模型，立即返回合成的 logits，用于测量主机侧开销
+};
+
+// 一个执行上下文：拥有自己的输入/输出缓冲区，可以与同一模型的其他上下文并发执行。
+// 调用顺序为 set_input_shape -> 写入 input() -> execute -> 读取 output()。
+class BackendContext {
+public:
+    virtual ~BackendContext() = default;
+
+    // 设置输入形状 (N, C, H, W) 并准备好缓冲区；缓冲区只在形状变大时重新分配
+    virtual bool set_input_shape(const TensorShape& shape) = 0;
+    // 主机内存中的 float32 NCHW 输入，set_input_shape 之后有效
+    virtual float* input() = 0;
+
+    // 执行推理，结果放到 output() 中
+    virtual bool execute() = 0;
+
+    // 以下在 execute 之后有效
+    virtual TensorShape output_shape() const = 0;
+    virtual TensorDataType output_type() const = 0;
+    virtual const void* output() const = 0;
+
+    // 该上下文持有的设备/主机缓冲区统计；没有设备内存的后端只填写 host
+    virtual void buffer_stats(BufferPoolStats& device, BufferPoolStats& host) const = 0;
+
+    // execute 把 H2D / 推理 / D2H 的耗时记录到 stats (可为空)
+    void set_stats(InferenceStats* stats) { this->stats_ = stats; }
+
+protected:
+    InferenceStats* stats_ = nullptr;
+};
+
+// 一个加载好的模型，只负责创建执行上下文
+class InferenceBackend {
+public:
+    virtual ~InferenceBackend() = default;
+
+    virtual const char* name() const = 0;
+    // 一次调用可以接受的最大批大小
+    virtual int max_batch_size() const = 0;
+    // 引擎是否接受 H x W 的输入 (固定尺寸或优化配置文件的范围)；用于校验 letterbox 的输入桶
+    virtual bool accepts_input_size(int /*height*/, int /*width*/) const { return true; }
+    // 失败时返回 nullptr；所有上下文必须在后端之前销毁
+    virtual std::unique_ptr<BackendContext> create_context() = 0;
+};
+
+// 失败时输出错误信息并返回 nullptr
+std::unique_ptr<InferenceBackend> create_backend(BackendKind kind, const std::string& model_path);
+std::unique_ptr<InferenceBackend> create_backend(BackendKind kind, const void* model_data, size_t model_size);
+
+#ifdef TRT_SEG_WITH_TENSORRT
+// 同一个 .engine 文件通过 EngineRegistry 在句柄之间共享
+std::unique_ptr<InferenceBackend> create_tensorrt_backend(const std::string& engine_path);
+std::unique_ptr<InferenceBackend> create_tensorrt_backend(const void* engine_data, size_t engine_size);
+#endif
+
+std::unique_ptr<InferenceBackend> create_opencv_backend(const std::string& onnx_path);
+std::unique_ptr<InferenceBackend> create_opencv_backend(const void* onnx_data, size_t onnx_size);
+
+// spec 形如 "classes=2,stride=1,max_batch=16,dtype=fp32"，空字符串使用默认值
+std::unique_ptr<InferenceBackend> create_null_backend(const std::string& spec);
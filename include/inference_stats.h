@@ -0,0 +1,201 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+#include "perf_counters.h"
+#include "trace_recorder.h"
+
+// 计时的阶段，顺序与 trt_segmentation.h 中的 TRT_SEG_STAGE 一致。
+// 缩放与归一化融合在 preprocess 中，因此没有单独的 resize 阶段。
+enum InferenceStage {
+    kStageTimeDecode = 0,      // 读取并解码输入文件
+    kStageTimePreprocess = 1,  // 缩放 + 归一化 + HWC -> CHW (每张图像)
+    kStageTimeH2D = 2,         // 输入拷贝到设备 (仅 GPU 后端)
+    kStageTimeExecute = 3,     // 后端推理 (每次调用，批处理时一次对应多张图像)
+    kStageTimeD2H = 4,         // 输出拷回主机 (仅 GPU 后端)
+    kStageTimePostprocess = 5, // argmax (每张图像)
+    kStageTimeUpscale = 6,     // 保留：最近邻放大已融合进 postprocess，不再单独记录
+    kStageTimeEncode = 7,      // imwrite
+    kStageTimeTotal = 8,       // 一个请求从开始到结束
+    kNumInferenceStages = 9,
+};
+
+// 阶段名称 (静态字符串)，用于 trace 导出
+const char* inference_stage_name(InferenceStage stage);
+
+struct LatencySummary {
+    uint64_t count = 0;
+    double mean_us = 0.0;
+    double p50_us = 0.0;
+    double p90_us = 0.0;
+    double p99_us = 0.0;
+    double p999_us = 0.0;
+    double max_us = 0.0;
+};
+
+// 无锁的对数-线性直方图 (HDR 风格)，单位为纳秒。
+// 每个 2 的幂区间分成 16 个桶，相对误差不超过 1/16；记录只是几次 relaxed 原子加法。
+class LatencyHistogram {
+public:
+    static constexpr int kSubBuckets = 16;
+    static constexpr int kMaxExponent = 42; // 2^42 ns ~ 73 分钟，更大的值计入最后一个桶
+    static constexpr int kNumBuckets = (kMaxExponent - 3) * kSubBuckets + kSubBuckets;
+
+    LatencyHistogram() { this->reset(); }
+
+    void record(uint64_t ns) {
+        this->buckets_[bucket_index(ns)].fetch_add(1, std::memory_order_relaxed);
+        this->count_.fetch_add(1, std::memory_order_relaxed);
+        this->sum_ns_.fetch_add(ns, std::memory_order_relaxed);
+        uint64_t max = this->max_ns_.load(std::memory_order_relaxed);
+        while (ns > max && !this->max_ns_.compare_exchange_weak(max, ns, std::memory_order_relaxed)) {
+        }
+    }
+
+    // 与并发的 record 之间没有同步，清零期间记录的样本可能部分丢失
+    void reset();
+
+    // 分位数取所在桶的中点
+    LatencySummary summary() const;
+
+    static int bucket_index(uint64_t ns);
+    static uint64_t bucket_lower_bound(int index);
+
+private:
+    std::atomic<uint64_t> buckets_[kNumBuckets];
+    std::atomic<uint64_t> count_;
+    std::atomic<uint64_t> sum_ns_;
+    std::atomic<uint64_t> max_ns_;
+};
+
+// 每个句柄一份，所有线程共享
+class InferenceStats {
+public:
+    void record(InferenceStage stage, uint64_t ns) { this->histograms_[stage].record(ns); }
+    // 记录到直方图，开启 trace 时同时记录一个属于当前请求的 span
+    void record_span(InferenceStage stage, TraceRecorder::Clock::time_point begin, TraceRecorder::Clock::time_point end) {
+        const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin);
+        this->record(stage, static_cast<uint64_t>(elapsed.count()));
+        this->trace_.record(inference_stage_name(stage), begin, end, TraceRequestScope::current());
+    }
+    LatencySummary summary(InferenceStage stage) const { return this->histograms_[stage].summary(); }
+    void reset() {
+        for (auto& histogram : this->histograms_) histogram.reset();
+        for (auto& counters : this->perf_) counters.reset();
+    }
+
+    // 硬件计数器默认关闭；当前线程无法打开计数器时开启失败并返回 false
+    bool enable_perf_counters(bool enable) {
+        if (enable && !PerfCounterGroup::for_current_thread()) return false;
+        this->perf_enabled_.store(enable, std::memory_order_relaxed);
+        return true;
+    }
+    bool perf_enabled() const { return this->perf_enabled_.load(std::memory_order_relaxed); }
+    void record_perf(InferenceStage stage, const PerfSample& delta, bool sample = true) {
+        this->perf_[stage].add(delta, sample);
+    }
+    PerfSummary perf_summary(InferenceStage stage) const { return this->perf_[stage].summary(); }
+
+    // 请求 ID 从 1 开始递增，0 表示不属于任何请求 (例如整个批次的推理)
+    uint64_t next_request_id() { return this->next_request_id_.fetch_add(1, std::memory_order_relaxed); }
+
+    TraceRecorder& trace() { return this->trace_; }
+    const TraceRecorder& trace() const { return this->trace_; }
+
+private:
+    LatencyHistogram histograms_[kNumInferenceStages];
+    PerfStageCounters perf_[kNumInferenceStages];
+    std::atomic<bool> perf_enabled_{false};
+    std::atomic<uint64_t> next_request_id_{1};
+    TraceRecorder trace_;
+};
+
+// 当前线程上正在累计硬件计数器的最内层阶段；stats 为空表示没有
+struct PerfStageContext {
+    InferenceStats* stats = nullptr;
+    InferenceStage stage = kStageTimeDecode;
+
+    static PerfStageContext& current() {
+        thread_local PerfStageContext context;
+        return context;
+    }
+};
+
+// 作用域计时器：记录到直方图，开启 trace 时同时记录一个 span，开启硬件计数器时
+// 累计本线程在该阶段内的计数。stats 为空时什么也不做
+class ScopedStageTimer {
+public:
+    ScopedStageTimer(InferenceStats* stats, InferenceStage stage) : stats_(stats), stage_(stage) {
+        if (!stats) return;
+        if (stats->perf_enabled()) {
+            this->perf_ = PerfCounterGroup::for_current_thread();
+            if (this->perf_ && !this->perf_->read(this->perf_start_)) this->perf_ = nullptr;
+            if (this->perf_) {
+                // Parallel regions opened inside this stage add their workers' counts to it
+                this->outer_ = PerfStageContext::current();
+                PerfStageContext::current() = PerfStageContext{stats, stage};
+            }
+        }
+        this->start_ = Clock::now();
+    }
+    ~ScopedStageTimer() { this->stop(); }
+
+    ScopedStageTimer(const ScopedStageTimer&) = delete;
+    ScopedStageTimer& operator=(const ScopedStageTimer&) = delete;
+
+    // 提前结束计时，之后的 stop/析构不再记录
+    void stop() {
+        if (!this->stats_) return;
+        const Clock::time_point end = Clock::now();
+        PerfSample perf_end;
+        if (this->perf_ && this->perf_->read(perf_end)) {
+            this->stats_->record_perf(this->stage_, PerfCounterGroup::delta(this->perf_start_, perf_end));
+        }
+        if (this->perf_) PerfStageContext::current() = this->outer_;
+        this->stats_->record_span(this->stage_, this->start_, end);
+        this->stats_ = nullptr;
+    }
+
+private:
+    using Clock = TraceRecorder::Clock;
+
+    InferenceStats* stats_;
+    InferenceStage stage_;
+    Clock::time_point start_;
+    PerfCounterGroup* perf_ = nullptr;
+    PerfSample perf_start_;
+    PerfStageContext outer_;
+};
+
+// cv::parallel_for_ 的工作线程不在调用方 ScopedStageTimer 的计数范围内。调用方在进入并行区域前
+// 取得 PerfStageContext::current()，并行体内构造本对象，工作线程在这一段的计数累加到同一阶段
+// (不增加采样次数)。执行并行体的线程本身已在某个阶段内 (调用方线程，或已有计时器的工作线程) 时不重复计数
+class ScopedWorkerCounters {
+public:
+    explicit ScopedWorkerCounters(const PerfStageContext& owner) {
+        if (!owner.stats || PerfStageContext::current().stats) return;
+        this->perf_ = PerfCounterGroup::for_current_thread();
+        if (!this->perf_ || !this->perf_->read(this->start_)) {
+            this->perf_ = nullptr;
+            return;
+        }
+        this->owner_ = owner;
+    }
+    ~ScopedWorkerCounters() {
+        PerfSample end;
+        if (this->perf_ && this->perf_->read(end)) {
+            this->owner_.stats->record_perf(this->owner_.stage, PerfCounterGroup::delta(this->start_, end), false);
+        }
+    }
+
+    ScopedWorkerCounters(const ScopedWorkerCounters&) = delete;
+    ScopedWorkerCounters& operator=(const ScopedWorkerCounters&) = delete;
+
+private:
+    PerfStageContext owner_;
+    PerfCounterGroup* perf_ = nullptr;
+    PerfSample start_;
+};
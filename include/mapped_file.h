@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+// 只读内存映射文件。映射时提示内核按顺序读取并提前预读，
+// 用于直接从页缓存反序列化引擎，避免先把整个文件读入 std::vector。
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // 失败时返回 false，并输出错误信息
+    bool open(const std::string& path);
+    void close();
+
+    const void* data() const { return this->data_; }
+    size_t size() const { return this->size_; }
+
+    // 打开的文件的标识 (设备/inode、大小、修改时间)，取自已打开的句柄，未打开时为空
+    const std::string& identity() const { return this->identity_; }
+
+private:
+    void* data_ = nullptr;
+    size_t size_ = 0;
+    std::string identity_;
+#ifdef _WIN32
+    void* file_ = nullptr;
+    void* mapping_ = nullptr;
+#endif
+};
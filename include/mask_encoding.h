@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// 前景掩码的输出格式。后处理只产生 0/255 两个值，PBM 和两种 RLE 都从 1 bit/像素的位图直接生成，
+// 不经过 8 bit 掩码，也不做 zlib 压缩；两种轮廓格式在模型分辨率的掩码上提取 (见 mask_polygons.h)
+enum class MaskFormat {
+    kPng = 0,           // 8 bit 灰度 PNG (cv::imwrite)
+    kPbm = 1,           // 二进制 PBM (P4)：头部之后直接是按行打包的位图，前景为 1
+    kRowRle = 2,        // 文本行程编码：首行 "RLE 宽 高"，之后每行一行，从背景开始交替的行程长度
+    kCocoRle = 3,       // COCO 格式的 JSON {"size": [高, 宽], "counts": "..."}，按列优先的压缩行程字符串
+    kPolygonJson = 4,   // 区域轮廓，GeoJSON
+    kPolygonBinary = 5, // 区域轮廓，紧凑的二进制格式
+};
+
+// 按扩展名选择：.pbm -> PBM, .rle -> 行程编码, .json -> COCO RLE,
+// .geojson -> 轮廓 GeoJSON, .poly -> 轮廓二进制, 其他 -> PNG
+MaskFormat mask_format_for_path(const std::string& path);
+
+inline bool is_polygon_format(MaskFormat format) {
+    return format == MaskFormat::kPolygonJson || format == MaskFormat::kPolygonBinary;
+}
+
+// 1 bit/像素的前景位图，每行 stride = ceil(width / 8) 字节，高位在前 (与 PBM 相同)
+struct PackedMask {
+    int width = 0;
+    int height = 0;
+    size_t stride = 0;
+    std::vector<uint8_t> bits;
+
+    void create(int w, int h);
+    bool empty() const { return this->bits.empty(); }
+    uint8_t* row(int y) { return this->bits.data() + static_cast<size_t>(y) * this->stride; }
+    const uint8_t* row(int y) const { return this->bits.data() + static_cast<size_t>(y) * this->stride; }
+};
+
+// 把一行 width 个字节 (非 0 为前景) 打包到 out。src_x 非空时第 x 位取 line[src_x[x]]，
+// 用于在打包的同时做最近邻放大
+void pack_row(const uint8_t* line, const int* src_x, int width, uint8_t* out);
+
+// 把 8 bit 掩码 (非 0 为前景) 打包成位图
+void pack_mask(const uint8_t* mask, size_t mask_stride, int width, int height, PackedMask& packed);
+
+// 一行的行程长度，从背景开始交替 (第一项可能为 0)，总和为 width
+void row_runs(const uint8_t* packed_row, int width, std::vector<uint32_t>& runs);
+
+// COCO RLE：按列优先扫描的行程，从背景开始交替；counts_string 为 pycocotools 的压缩字符串编码
+void coco_runs(const PackedMask& packed, std::vector<uint32_t>& runs);
+std::string coco_counts_string(const std::vector<uint32_t>& runs);
+
+// 按格式写出文件；kPng 和轮廓格式不由这里处理，返回 -1
+int write_packed_mask(const std::string& path, MaskFormat format, const PackedMask& packed);
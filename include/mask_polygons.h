@@ -0,0 +1,24 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <opencv2/opencv.hpp>
+
+// 一条轮廓环。外轮廓的 parent 为 -1；孔洞的 parent 为所属外轮廓在结果中的下标
+struct PolygonRing {
+    int class_id = 0; // 区域在输出中的像素值：类别索引，二值掩码时为 255
+    int parent = -1;
+    std::vector<float> xy; // x0, y0, x1, y1, ...，原始图像坐标 (像素中心)，首尾不重复
+};
+
+// 在模型分辨率的输出 (0 为背景) 上提取每个类别的区域轮廓 (外轮廓 + 孔洞)，用 Douglas-Peucker
+// 以 epsilon (模型分辨率的像素) 简化后，按最近邻放大的对应关系换算到 width x height 的原始坐标。
+// 简化后少于 3 个点的环 (1~2 个像素宽的碎片) 被丢弃，外轮廓被丢弃时其孔洞也一并丢弃
+void trace_polygons(const cv::Mat& labels, double epsilon, int width, int height, std::vector<PolygonRing>& rings);
+
+// 写出轮廓：json 为 GeoJSON FeatureCollection (每个外轮廓及其孔洞为一个 Polygon，环首尾闭合)，
+// 否则为紧凑的二进制格式 (小端)：
+//   "SEGP" | uint32 版本 (1) | uint32 宽 | uint32 高 | uint32 环数 |
+//   每个环: int32 class_id | int32 parent | uint32 点数 n | float32 x, y 各 n 对
+int write_polygons(const std::string& path, bool json, const std::vector<PolygonRing>& rings, int width, int height);
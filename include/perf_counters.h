@@ -0,0 +1,82 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+// 基于 Linux perf_event_open 的硬件性能计数器，只统计当前线程在用户态的事件。
+// 其他平台上 for_current_thread() 始终返回空指针。
+
+enum PerfCounter {
+    kPerfCycles = 0,
+    kPerfInstructions = 1,
+    kPerfLLCMisses = 2,    // 末级缓存未命中
+    kPerfBranchMisses = 3, // 分支预测失败
+    kNumPerfCounters = 4,
+};
+
+// 一次读数。计数器组被内核多路复用时，按 enabled/running 时间比例缩放
+struct PerfSample {
+    uint64_t values[kNumPerfCounters] = {0, 0, 0, 0};
+    uint64_t time_enabled = 0;
+    uint64_t time_running = 0;
+};
+
+// 每个线程一组计数器 (以 cycles 为组长)，所有句柄共用
+class PerfCounterGroup {
+public:
+    // 首次调用时打开；内核不允许 (perf_event_paranoid) 或不支持时返回空指针。
+    // 单个事件 (例如虚拟机中的 LLC 未命中) 不可用时该项始终为 0
+    static PerfCounterGroup* for_current_thread();
+
+    ~PerfCounterGroup();
+
+    PerfCounterGroup(const PerfCounterGroup&) = delete;
+    PerfCounterGroup& operator=(const PerfCounterGroup&) = delete;
+
+    bool read(PerfSample& out) const;
+
+    // end - begin，已按多路复用比例缩放
+    static PerfSample delta(const PerfSample& begin, const PerfSample& end);
+
+private:
+    PerfCounterGroup() = default;
+    bool open();
+
+    int leader_fd_ = -1;
+    int fds_[kNumPerfCounters] = {-1, -1, -1, -1};
+    int slots_[kNumPerfCounters] = {-1, -1, -1, -1}; // 在组读取结果中的位置，-1 表示未打开
+    int num_open_ = 0;
+};
+
+struct PerfSummary {
+    uint64_t count = 0; // 采样的阶段次数
+    uint64_t totals[kNumPerfCounters] = {0, 0, 0, 0};
+};
+
+// 一个阶段的计数器累计值，多线程写入无锁
+class PerfStageCounters {
+public:
+    PerfStageCounters() { this->reset(); }
+
+    // sample 为 false 时只累加计数 (并行区域中工作线程的份额)，不增加采样次数
+    void add(const PerfSample& delta, bool sample = true) {
+        for (int i = 0; i < kNumPerfCounters; ++i) this->totals_[i].fetch_add(delta.values[i], std::memory_order_relaxed);
+        if (sample) this->count_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void reset() {
+        for (auto& total : this->totals_) total.store(0, std::memory_order_relaxed);
+        this->count_.store(0, std::memory_order_relaxed);
+    }
+
+    PerfSummary summary() const {
+        PerfSummary summary;
+        summary.count = this->count_.load(std::memory_order_relaxed);
+        for (int i = 0; i < kNumPerfCounters; ++i) summary.totals[i] = this->totals_[i].load(std::memory_order_relaxed);
+        return summary;
+    }
+
+private:
+    std::atomic<uint64_t> count_;
+    std::atomic<uint64_t> totals_[kNumPerfCounters];
+};
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "spsc_queue.h"
+#include "worker_pool.h"
+
+class TRTSegmentation;
+
+enum PipelineStage {
+    kStageDecode = 0, // 预处理 (文件读取和解码在 I/O 线程上，见 stats 的 io)
+    kStageInfer = 1,  // H2D + 推理 + D2H
+    kStageEncode = 2, // 后处理，直接写成原始分辨率 (imwrite 交给 I/O 线程)
+    kNumPipelineStages = 3,
+};
+
+struct PipelineStageStats {
+    size_t queue_depth = 0;    // 等待该阶段处理的请求数
+    size_t queue_capacity = 0;
+    uint64_t items = 0;        // 已处理的请求数
+    double busy_ratio = 0.0;   // 阶段线程处于工作状态的时间占比 (不含等待执行上下文和队列的时间)
+};
+
+// 三段式流水线：每个阶段一个专用线程，阶段之间用有界无锁队列连接，
+// 因此第 k+1 张图像解码时第 k 张在推理、第 k-1 张在编码写出。
+// 每个在途请求占用一个执行上下文 (从解码阶段到编码阶段)，
+// 所以执行上下文池至少需要 3 个才能让三个阶段完全重叠。
+// 文件读取/解码在提交时就交给 I/O 线程池预先开始，PNG 编码和写出也在 I/O 线程上异步完成，
+// 因此阶段线程上只剩下与推理相关的工作。
+class SegmentationPipeline {
+public:
+    using Completion = std::function<void(int status)>;
+
+    SegmentationPipeline(TRTSegmentation& owner, size_t queue_depth, size_t io_threads);
+    // 处理完所有已提交的请求后退出
+    ~SegmentationPipeline();
+
+    SegmentationPipeline(const SegmentationPipeline&) = delete;
+    SegmentationPipeline& operator=(const SegmentationPipeline&) = delete;
+
+    // 线程安全；第一个队列满时阻塞。done 在编码阶段线程或 I/O 线程上调用。
+    // 输出格式由 output_mask_path 的扩展名决定 (见 mask_format_for_path)
+    void submit(const std::string& image_path, const std::string& output_mask_path, Completion done = nullptr);
+
+    // 等待所有已提交的请求完成，返回自上次 flush 以来失败的请求数
+    int flush();
+
+    // io 为 I/O 线程池：queue_depth 为已提交未完成的读取和写出任务数，queue_capacity 为线程数，
+    // items 为完成的任务数，busy_ratio 为所有 I/O 线程的平均忙碌比例
+    void stats(PipelineStageStats out[kNumPipelineStages], PipelineStageStats& io) const;
+
+private:
+    struct Item;
+
+    void decode_loop();
+    void infer_loop();
+    void encode_loop();
+    // 把 item 中的掩码交给 I/O 线程编码写出，写完后完成请求；待写出的掩码过多时阻塞
+    void write_async(Item* item);
+    // 在 I/O 线程上执行 task，并计入 I/O 的统计
+    void post_io(std::function<void()> task);
+    void complete(Item* item);
+
+    // 把 item 放入队列，队列满时退避等待
+    static void push(SpscQueue<Item*>& queue, Item* item);
+    // 取出一个 item；上游已结束且队列为空时返回 false
+    static bool pop(SpscQueue<Item*>& queue, const std::atomic<bool>& upstream_done, Item*& item);
+
+    TRTSegmentation& owner_;
+    SpscQueue<Item*> queues_[kNumPipelineStages];
+    std::atomic<bool> done_[kNumPipelineStages];
+    std::atomic<bool> stopping_{false};
+
+    std::atomic<uint64_t> items_[kNumPipelineStages];
+    std::atomic<uint64_t> busy_ns_[kNumPipelineStages];
+    std::atomic<uint64_t> io_items_{0};
+    std::atomic<uint64_t> io_busy_ns_{0};
+    std::atomic<size_t> io_pending_{0};
+    std::chrono::steady_clock::time_point started_;
+
+    std::mutex submit_mutex_; // 保证第一个队列只有一个生产者
+
+    std::mutex completion_mutex_;
+    std::condition_variable completion_cv_;
+    uint64_t submitted_ = 0;
+    uint64_t completed_ = 0;
+    int failures_ = 0;
+
+    std::mutex write_mutex_;
+    std::condition_variable write_cv_;
+    size_t pending_writes_ = 0;
+    const size_t max_pending_writes_;
+
+    std::thread threads_[kNumPipelineStages];
+
+    // 最后声明：析构时最先执行完剩余的写出任务，它们还会用到上面的成员
+    WorkerPool io_;
+};
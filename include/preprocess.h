@@ -0,0 +1,87 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// 输入像素的排列方式，顺序与公共头文件中的 TRT_SEG_PIXEL_FORMAT 一致
+enum class PixelFormat {
+    kBGR,
+    kRGB,
+    kBGRA,
+    kRGBA,
+    kGray,
+};
+
+inline int pixel_format_channels(PixelFormat format) {
+    switch (format) {
+        case PixelFormat::kBGR:
+        case PixelFormat::kRGB: return 3;
+        case PixelFormat::kBGRA:
+        case PixelFormat::kRGBA: return 4;
+        case PixelFormat::kGray: return 1;
+    }
+    return 0;
+}
+
+// 调用方像素缓冲区的只读视图，不拥有也不复制内存
+struct ImageView {
+    const uint8_t* data = nullptr;
+    int width = 0;
+    int height = 0;
+    size_t stride = 0; // 每行字节数
+    PixelFormat format = PixelFormat::kBGR;
+};
+
+// 保持宽高比的输入桶：模型输入张量的宽 x 高 (须落在引擎优化配置文件的范围内)
+struct ShapeBucket {
+    int width = 0;
+    int height = 0;
+};
+
+// 一张图像在模型输入中的位置：输入张量为 input_width x input_height，
+// 缩放后的图像位于左上角的 content_width x content_height 区域，其余部分为填充
+struct InputGeometry {
+    int input_width = 0;
+    int input_height = 0;
+    int content_width = 0;
+    int content_height = 0;
+};
+
+// letterbox：在能以原始大小放下图像的桶中选面积最小的 (不放大)；都放不下时选缩放比例最大的
+// (比例相同时选面积小的)，内容按该比例缩放。buckets 不能为空
+InputGeometry letterbox_geometry(const std::vector<ShapeBucket>& buckets, int width, int height);
+
+// 融合的预处理引擎：一次读取 uint8 源像素，
+// 在同一遍中完成双线性缩放、均值/方差归一化以及 HWC -> CHW 转换，
+// 结果直接写入 planar float 输入缓冲区。
+class PreprocessEngine {
+public:
+    PreprocessEngine();
+
+    // 设置每个通道的均值和标准差（针对 [0,1] 范围的像素值），
+    // 内部折叠为 out = pixel * scale + bias。
+    void set_normalization(const float mean[3], const float std[3]);
+
+    // src: 任意 PixelFormat 的交错像素，输出平面始终按 B, G, R 顺序排列
+    //      (灰度图复制到三个平面)，alpha 通道被忽略
+    // dst: 3 * dst_h * dst_w 个 float，按 CHW 排列
+    void run(const ImageView& src, float* dst, int dst_w, int dst_h);
+    // letterbox：图像缩放到 dst 左上角的 content_w x content_h，其余像素写 0 (归一化后即均值颜色)
+    void run(const ImageView& src, float* dst, int dst_w, int dst_h, int content_w, int content_h);
+
+private:
+    void update_tables(int src_w, int src_h, int channels, int dst_w, int dst_h);
+
+    float scale_[3];
+    float bias_[3];
+
+    // 缓存的采样坐标表，只有尺寸变化时才重新计算
+    int src_w_ = 0, src_h_ = 0, channels_ = 0, dst_w_ = 0, dst_h_ = 0;
+    std::vector<int> x_ofs0_;   // 每个输出列左侧源像素的字节偏移 (x0 * channels)
+    std::vector<int> x_ofs1_;   // 每个输出列右侧源像素的字节偏移 (x1 * channels)
+    std::vector<float> x_frac_; // 每个输出列的水平插值权重
+    std::vector<int> y_idx0_;   // 每个输出行上方的源行号
+    std::vector<int> y_idx1_;   // 每个输出行下方的源行号
+    std::vector<float> y_frac_; // 每个输出行的垂直插值权重
+};
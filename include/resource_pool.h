@@ -0,0 +1,99 @@
+#pragma once
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// 固定大小的资源池。acquire() 在没有空闲资源时阻塞，
+// 返回的 Lease 析构时自动把资源归还到池中。
+template <typename T>
+class ResourcePool {
+public:
+    class Lease {
+    public:
+        Lease() = default;
+        Lease(ResourcePool* pool, T* item) : pool_(pool), item_(item) {}
+        Lease(Lease&& other) noexcept : pool_(other.pool_), item_(other.item_) {
+            other.pool_ = nullptr;
+            other.item_ = nullptr;
+        }
+        Lease& operator=(Lease&& other) noexcept {
+            if (this != &other) {
+                this->release();
+                this->pool_ = other.pool_;
+                this->item_ = other.item_;
+                other.pool_ = nullptr;
+                other.item_ = nullptr;
+            }
+            return *this;
+        }
+        Lease(const Lease&) = delete;
+        Lease& operator=(const Lease&) = delete;
+        ~Lease() { this->release(); }
+
+        T* get() const { return this->item_; }
+        T* operator->() const { return this->item_; }
+        T& operator*() const { return *this->item_; }
+        explicit operator bool() const { return this->item_ != nullptr; }
+
+        void release() {
+            if (this->pool_ && this->item_) {
+                this->pool_->give_back(this->item_);
+            }
+            this->pool_ = nullptr;
+            this->item_ = nullptr;
+        }
+
+    private:
+        ResourcePool* pool_ = nullptr;
+        T* item_ = nullptr;
+    };
+
+    // 只能在没有任何 Lease 存活时调用 (例如初始化阶段)
+    void add(std::unique_ptr<T> item) {
+        std::lock_guard<std::mutex> lock(this->mutex_);
+        this->idle_.push_back(item.get());
+        this->items_.push_back(std::move(item));
+    }
+
+    void clear() {
+        std::lock_guard<std::mutex> lock(this->mutex_);
+        this->idle_.clear();
+        this->items_.clear();
+    }
+
+    Lease acquire() {
+        std::unique_lock<std::mutex> lock(this->mutex_);
+        this->cv_.wait(lock, [this] { return !this->idle_.empty(); });
+        T* item = this->idle_.back();
+        this->idle_.pop_back();
+        return Lease(this, item);
+    }
+
+    size_t size() const {
+        std::lock_guard<std::mutex> lock(this->mutex_);
+        return this->items_.size();
+    }
+
+    // 遍历所有资源 (不论是否被借出)，仅用于读取统计信息等线程安全的操作
+    template <typename Fn>
+    void for_each(Fn&& fn) const {
+        std::lock_guard<std::mutex> lock(this->mutex_);
+        for (const auto& item : this->items_) fn(static_cast<const T&>(*item));
+    }
+
+private:
+    void give_back(T* item) {
+        {
+            std::lock_guard<std::mutex> lock(this->mutex_);
+            this->idle_.push_back(item);
+        }
+        this->cv_.notify_one();
+    }
+
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    std::vector<std::unique_ptr<T>> items_;
+    std::vector<T*> idle_;
+};
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+// 有界单生产者/单消费者无锁环形队列。
+// 容量向上取整为 2 的幂；head/tail 各占一个缓存行，避免生产者和消费者之间的伪共享。
+template <typename T>
+class SpscQueue {
+public:
+    explicit SpscQueue(size_t capacity) {
+        size_t n = 2;
+        while (n < capacity) n <<= 1;
+        this->slots_.resize(n);
+        this->mask_ = n - 1;
+    }
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    // 仅生产者线程调用
+    bool try_push(const T& value) {
+        const size_t tail = this->tail_.load(std::memory_order_relaxed);
+        if (tail - this->head_.load(std::memory_order_acquire) > this->mask_) return false;
+        this->slots_[tail & this->mask_] = value;
+        this->tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // 仅消费者线程调用
+    bool try_pop(T& value) {
+        const size_t head = this->head_.load(std::memory_order_relaxed);
+        if (head == this->tail_.load(std::memory_order_acquire)) return false;
+        value = this->slots_[head & this->mask_];
+        this->head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // 任意线程调用，结果只是一个瞬时值
+    size_t size() const {
+        const size_t tail = this->tail_.load(std::memory_order_acquire);
+        const size_t head = this->head_.load(std::memory_order_acquire);
+        return tail - head;
+    }
+
+    size_t capacity() const { return this->mask_ + 1; }
+
+private:
+    static constexpr size_t kCacheLine = 64;
+
+    alignas(kCacheLine) std::atomic<size_t> head_{0};
+    alignas(kCacheLine) std::atomic<size_t> tail_{0};
+    alignas(kCacheLine) std::vector<T> slots_;
+    size_t mask_ = 0;
+};
+
+// 队列满/空时的退避：先让出时间片，持续等待后逐渐改为短暂休眠，避免空闲的阶段线程占满 CPU
+class Backoff {
+public:
+    void pause() {
+        if (this->spins_ < 64) {
+            ++this->spins_;
+            std::this_thread::yield();
+        } else {
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+        }
+    }
+    void reset() { this->spins_ = 0; }
+
+private:
+    int spins_ = 0;
+};
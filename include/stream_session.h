@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include <opencv2/opencv.hpp>
+
+#include "argmax.h"
+#include "preprocess.h"
+#include "tile_stitcher.h"
+
+class TRTSegmentation;
+
+// 线扫相机的流式会话：调用方不断推入固定宽度的像素行，会话在滑动窗口中凑满模型输入高度的行后
+// 立即推理 (宽度超过模型输入时横向分块)，相邻窗口重叠 overlap 行，logits 由 TileStitcher 拼接，
+// 不会再被后续窗口影响的掩码行进入输出队列。从推入一行到它的掩码可以取出，最多相隔一个窗口。
+//
+// push_rows / finish 只能在一个线程上调用 (推理在该线程上同步执行)；pop_mask_rows 可以在另一个线程上调用。
+// 会话必须在所属的 TRTSegmentation 销毁之前关闭。
+class StreamSession {
+public:
+    StreamSession(TRTSegmentation& owner, int width, PixelFormat format, int overlap, ArgmaxOutput mode);
+
+    StreamSession(const StreamSession&) = delete;
+    StreamSession& operator=(const StreamSession&) = delete;
+
+    // 复制 num_rows 行 (每行 stride 字节) 到窗口，每凑满一个窗口就推理一次
+    int push_rows(const uint8_t* rows, int num_rows, size_t stride);
+
+    // 取出最多 max_rows 行掩码 (每行 width 字节)，返回实际取出的行数；stride 小于 width 时返回 -1
+    int pop_mask_rows(uint8_t* mask, int max_rows, size_t stride);
+
+    // 输入结束：剩余的行补边后推理一次，之后所有掩码行都可以取出，不能再推入
+    int finish();
+
+private:
+    // 推理当前窗口中的 filled_ 行，并输出 emit_until 之前的掩码行
+    int run_window(int64_t emit_until);
+    int emit(int64_t emit_until);
+
+    TRTSegmentation& owner_;
+    const int width_;
+    const PixelFormat format_;
+    const ArgmaxOutput mode_;
+    const int window_rows_; // 模型输入高度
+    const int step_rows_;   // 相邻窗口的起始行之差 = window_rows_ - overlap
+    const std::vector<int> xs_;
+
+    cv::Mat window_;       // window_rows_ 行的输入窗口，连续存储
+    int filled_ = 0;       // 窗口中已有的行数
+    int carried_ = 0;      // 其中从上一个窗口保留下来的重叠行数
+    int64_t window_y_ = 0; // 窗口第一行在整个流中的行号
+    bool finished_ = false;
+    TileStitcher stitcher_;
+    std::vector<uint8_t> scratch_; // emit 的临时输出，避免持锁做 argmax
+
+    std::mutex mask_mutex_;
+    std::vector<uint8_t> mask_rows_; // 待取出的掩码行 (每行 width_ 字节)，从 mask_head_ 行开始有效
+    size_t mask_head_ = 0;
+};
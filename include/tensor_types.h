@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// 与推理后端无关的张量元素类型
+enum class TensorDataType {
+    kFloat32,
+    kFloat16,
+    kInt32,
+    kInt64,
+    kUint8,
+};
+
+inline size_t data_type_size(TensorDataType type) {
+    switch (type) {
+        case TensorDataType::kFloat32: return 4;
+        case TensorDataType::kFloat16: return 2;
+        case TensorDataType::kInt32: return 4;
+        case TensorDataType::kInt64: return 8;
+        case TensorDataType::kUint8: return 1;
+    }
+    return 0;
+}
+
+// 张量形状，例如 {N, C, H, W}
+using TensorShape = std::vector<int64_t>;
+
+inline size_t shape_volume(const TensorShape& shape) {
+    size_t vol = 1;
+    for (int64_t d : shape) vol *= static_cast<size_t>(d);
+    return vol;
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "argmax.h"
+#include "tensor_types.h"
+
+// 沿一个方向切分的分块起点：length <= tile 时只有一块 (从 0 开始，超出部分需要补边)；
+// 否则相邻分块至少重叠 overlap 个像素，起点均匀分布且最后一块与末端对齐
+std::vector<int> tile_positions(int length, int tile, int overlap);
+
+// 把重叠分块的 logits 按权重累加后做 argmax，写回原始分辨率的掩码。
+//
+// 权重在分块边缘从 1 线性升到 overlap + 1 (行、列方向可分离)，重叠区域因此平滑过渡。
+// argmax 只需要比较 Σw·logit 的大小，无需再除以 Σw。
+// 只保留 tile_height 行的累加缓冲区 (环形)：分块必须按行从上到下提交，
+// emit(y) 输出 y 之前已经完整的行并回收它们的空间，因此内存与图像高度无关，
+// 也可以用于高度事先未知的流式输入 (行号为 64 位)。
+class TileStitcher {
+public:
+    // height 未知时传 kUnboundedHeight，结束时再通过 set_height 确定
+    static constexpr int64_t kUnboundedHeight = INT64_MAX;
+
+    TileStitcher(int width, int64_t height, int tile_width, int tile_height, int overlap);
+
+    void set_height(int64_t height) { this->height_ = height; }
+
+    // 累加一个起点在 (x, y) 的分块。logits 为 (N, C, h, w) 输出中该分块的起始位置；
+    // 模型输出分辨率与分块不同时按最近邻对应。不在图像内的 (补边) 像素被忽略。
+    // 要求 y 不早于上一次 emit 的位置，且分块不超出环形缓冲区
+    void add(int x, int64_t y, const float* logits, const TensorShape& shape);
+
+    // 对 [emitted_rows(), y_end) 行做 argmax，mask 指向其中的第一行
+    void emit(int64_t y_end, uint8_t* mask, size_t mask_stride, ArgmaxOutput mode);
+
+    int64_t emitted_rows() const { return this->emitted_; }
+
+private:
+    float* row(int64_t y) { return this->accumulator_.data() + static_cast<size_t>(y % this->tile_height_) * this->row_floats_; }
+
+    const int width_;
+    int64_t height_;
+    const int tile_width_;
+    const int tile_height_;
+    std::vector<float> weight_x_; // 分块内每一列的权重
+    std::vector<float> weight_y_; // 分块内每一行的权重
+
+    int num_classes_ = 0; // 第一个分块到达时确定
+    size_t row_floats_ = 0; // 每行 num_classes * width 个累加值，按类别分平面
+    std::vector<float> accumulator_;
+    int64_t emitted_ = 0;
+};
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// 当前线程正在处理的请求 ID，附加到记录的每个 span 上，用于跨线程关联同一个请求
+class TraceRequestScope {
+public:
+    explicit TraceRequestScope(uint64_t request_id) : previous_(current_) { current_ = request_id; }
+    ~TraceRequestScope() { current_ = this->previous_; }
+
+    TraceRequestScope(const TraceRequestScope&) = delete;
+    TraceRequestScope& operator=(const TraceRequestScope&) = delete;
+
+    static uint64_t current() { return current_; }
+
+private:
+    static thread_local uint64_t current_;
+    uint64_t previous_;
+};
+
+// 可选的 span 记录器，导出为 Chrome / Perfetto 的 trace JSON。
+// 每个线程写自己的环形缓冲区 (单生产者、无锁)，写满后覆盖最旧的事件；
+// 关闭时 record() 只有一次 relaxed 读，因此可以一直编译在生产版本中。
+class TraceRecorder {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    TraceRecorder();
+    ~TraceRecorder();
+
+    TraceRecorder(const TraceRecorder&) = delete;
+    TraceRecorder& operator=(const TraceRecorder&) = delete;
+
+    // 开始记录；之前记录的事件在导出时被忽略。
+    // events_per_thread 只对此后第一次记录的线程生效
+    void enable(size_t events_per_thread);
+    void disable();
+    bool enabled() const { return this->enabled_.load(std::memory_order_relaxed); }
+
+    // name 必须是静态字符串
+    void record(const char* name, Clock::time_point begin, Clock::time_point end, uint64_t request_id) {
+        if (!this->enabled()) return;
+        this->thread_buffer()->push(name, this->to_ns(begin), this->to_ns(end), request_id);
+    }
+
+    // 可以在记录的同时调用；正在被覆盖的事件会被跳过
+    bool dump(const std::string& path) const;
+
+private:
+    // 每个事件带一个序号 (seqlock)：写入前清零，写完后置为 index + 1，
+    // 读取方前后两次读到相同的序号才认为事件完整
+    struct Event {
+        std::atomic<uint64_t> seq{0};
+        std::atomic<uint64_t> begin_ns{0};
+        std::atomic<uint64_t> end_ns{0};
+        std::atomic<uint64_t> request{0};
+        std::atomic<const char*> name{nullptr};
+    };
+
+    struct ThreadBuffer {
+        ThreadBuffer(size_t capacity, int thread_index) : events(capacity), index(thread_index) {}
+
+        void push(const char* event_name, uint64_t begin, uint64_t end, uint64_t request_id) {
+            const uint64_t i = this->head.load(std::memory_order_relaxed);
+            Event& e = this->events[i % this->events.size()];
+            e.seq.store(0, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            e.begin_ns.store(begin, std::memory_order_relaxed);
+            e.end_ns.store(end, std::memory_order_relaxed);
+            e.request.store(request_id, std::memory_order_relaxed);
+            e.name.store(event_name, std::memory_order_relaxed);
+            e.seq.store(i + 1, std::memory_order_release);
+            this->head.store(i + 1, std::memory_order_release);
+        }
+
+        std::vector<Event> events;
+        std::atomic<uint64_t> head{0};
+        const int index;
+    };
+
+    ThreadBuffer* thread_buffer();
+    uint64_t to_ns(Clock::time_point t) const {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(t - this->origin_).count());
+    }
+
+    const uint64_t id_; // 进程内唯一，用于校验线程局部缓存
+    const Clock::time_point origin_;
+    std::atomic<bool> enabled_{false};
+    std::atomic<uint64_t> enabled_at_ns_{0};
+
+    mutable std::mutex mutex_;
+    size_t events_per_thread_ = 0;
+    std::map<std::thread::id, std::unique_ptr<ThreadBuffer>> buffers_;
+};
@@ -11,6 +11,9 @@
     #define TRT_SEG_API __attribute__((visibility("default")))
 #endif
 
+#include <stddef.h>
+#include <stdint.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -18,6 +21,135 @@ extern "C" {
 // 使用一个不透明指针来隐藏内部 C++ 实现
 typedef void* TRT_SEG_HANDLE;
 
+// 流式会话 (stream_open 返回)
+typedef void* TRT_SEG_STREAM;
+
+// run_inference_buffer 接受的像素格式 (每通道 8 位，交错排列)
+typedef enum TRT_SEG_PIXEL_FORMAT {
+    TRT_SEG_PIXEL_BGR8 = 0,
+    TRT_SEG_PIXEL_RGB8 = 1,
+    TRT_SEG_PIXEL_BGRA8 = 2,
+    TRT_SEG_PIXEL_RGBA8 = 3,
+    TRT_SEG_PIXEL_GRAY8 = 4,
+} TRT_SEG_PIXEL_FORMAT;
+
+// 掩码文件的格式，用于 run_inference_ex。run_inference / 流水线 / 批量接口按输出路径的扩展名选择：
+// .pbm -> PBM, .rle -> ROW_RLE, .json -> COCO_RLE, .geojson -> POLYGON_JSON, .poly -> POLYGON_BINARY, 其他 -> PNG
+typedef enum TRT_SEG_MASK_FORMAT {
+    TRT_SEG_MASK_PNG = 0,      // 8 bit 灰度 PNG，前景 255 (默认)
+    TRT_SEG_MASK_PBM = 1,      // 二进制 PBM (P4)，每像素 1 bit，前景为 1；不压缩，写出最快
+    TRT_SEG_MASK_ROW_RLE = 2,  // 文本：首行 "RLE 宽 高"，之后每个图像行一行，从背景开始交替的行程长度
+    TRT_SEG_MASK_COCO_RLE = 3, // JSON {"size": [高, 宽], "counts": "..."}，与 pycocotools 的压缩 RLE 相同
+    TRT_SEG_MASK_POLYGON_JSON = 4,   // 区域轮廓 (不生成栅格)，GeoJSON FeatureCollection，原始图像坐标
+    TRT_SEG_MASK_POLYGON_BINARY = 5, // 区域轮廓，紧凑的二进制格式，见 include/mask_polygons.h
+} TRT_SEG_MASK_FORMAT;
+
+// run_inference_buffer_confidence 的置信度格式
+typedef enum TRT_SEG_CONFIDENCE_FORMAT {
+    TRT_SEG_CONFIDENCE_U8 = 0,  // 每像素 1 字节，概率 * 255 四舍五入
+    TRT_SEG_CONFIDENCE_F16 = 1, // 每像素 2 字节，IEEE fp16
+} TRT_SEG_CONFIDENCE_FORMAT;
+
+// 推理后端，通过 set_backend 在 init_engine 之前选择
+typedef enum TRT_SEG_BACKEND {
+    TRT_SEG_BACKEND_TENSORRT = 0,   // .engine 文件，GPU 推理 (默认)
+    TRT_SEG_BACKEND_OPENCV_CPU = 1, // .onnx 文件，OpenCV DNN 在 CPU 上多线程推理
+    TRT_SEG_BACKEND_NULL = 2,       // 不加载模型，立即返回合成的 logits；init_engine 的路径参数为
+                                    // "classes=2,stride=1,max_batch=16,dtype=fp32" 形式的配置 (可为空字符串)；
+                                    // dtype 可为 fp32/fp16 (NCHW 分数) 或 int32/int64 (NHW 类别索引图)
+} TRT_SEG_BACKEND;
+
+// 流水线阶段编号：0 = 预处理, 1 = 推理, 2 = 后处理 (文件读取+解码、编码+写出在 I/O 线程池上，见 io)
+#define TRT_SEG_PIPELINE_STAGES 3
+
+typedef struct TRT_SEG_PIPELINE_STAGE_STATS {
+    int queue_depth;             // 当前等待该阶段处理的请求数
+    int queue_capacity;          // 该阶段输入队列的容量
+    unsigned long long items;    // 已处理的请求数
+    double busy_ratio;           // 阶段线程处于工作状态的时间占比 (0~1)，最接近 1 的阶段限制了吞吐；
+                                 // 等待执行上下文或上下游队列的时间不计入
+} TRT_SEG_PIPELINE_STAGE_STATS;
+
+typedef struct TRT_SEG_PIPELINE_STATS {
+    TRT_SEG_PIPELINE_STAGE_STATS stages[TRT_SEG_PIPELINE_STAGES];
+    // I/O 线程池：queue_depth 为已提交未完成的读取和写出任务数，queue_capacity 为 I/O 线程数，
+    // items 为完成的任务数，busy_ratio 为所有 I/O 线程的平均忙碌比例
+    TRT_SEG_PIPELINE_STAGE_STATS io;
+} TRT_SEG_PIPELINE_STATS;
+
+// 缓冲区池统计 (所有执行上下文之和)
+typedef struct TRT_SEG_BUFFER_STATS {
+    unsigned long long device_allocations;          // 实际 cudaMalloc 的次数
+    unsigned long long device_reuses;               // 直接复用已有设备缓冲区的次数
+    unsigned long long device_reserved_bytes;       // 当前持有的设备内存
+    unsigned long long device_peak_reserved_bytes;  // 设备内存的高水位
+    unsigned long long host_allocations;            // 实际 cudaMallocHost 的次数
+    unsigned long long host_reuses;
+    unsigned long long host_reserved_bytes;
+    unsigned long long host_peak_reserved_bytes;
+} TRT_SEG_BUFFER_STATS;
+
+// 延迟统计的阶段编号。缩放与归一化融合在 PREPROCESS 中，没有单独的 resize 阶段
+typedef enum TRT_SEG_STAGE {
+    TRT_SEG_STAGE_DECODE = 0,      // 读取并解码输入文件
+    TRT_SEG_STAGE_PREPROCESS = 1,  // 缩放 + 归一化 (每张图像)
+    TRT_SEG_STAGE_H2D = 2,         // 输入拷贝到设备 (仅 TensorRT 后端)
+    TRT_SEG_STAGE_EXECUTE = 3,     // 推理 (每次引擎调用，动态批处理时对应多张图像)
+    TRT_SEG_STAGE_D2H = 4,         // 输出拷回主机 (仅 TensorRT 后端)
+    TRT_SEG_STAGE_POSTPROCESS = 5, // argmax (每张图像)
+    TRT_SEG_STAGE_UPSCALE = 6,     // 保留：放大回原始分辨率已融合进 POSTPROCESS，计数始终为 0
+    TRT_SEG_STAGE_ENCODE = 7,      // imwrite
+    TRT_SEG_STAGE_TOTAL = 8,       // 一个请求从开始到结束 (流水线模式下从提交到写出完成)
+} TRT_SEG_STAGE;
+
+#define TRT_SEG_NUM_STAGES 9
+
+// 单个阶段的延迟分布，单位微秒；分位数的相对误差不超过约 6%
+typedef struct TRT_SEG_STAGE_STATS {
+    unsigned long long count;  // 样本数
+    double mean_us;
+    double p50_us;
+    double p90_us;
+    double p99_us;
+    double p999_us;
+    double max_us;
+} TRT_SEG_STAGE_STATS;
+
+typedef struct TRT_SEG_INFERENCE_STATS {
+    TRT_SEG_STAGE_STATS stages[TRT_SEG_NUM_STAGES]; // 以 TRT_SEG_STAGE 为下标
+} TRT_SEG_INFERENCE_STATS;
+
+// 一个阶段的硬件计数器累计值 (用户态，只统计执行该阶段的线程)
+typedef struct TRT_SEG_STAGE_PERF {
+    unsigned long long count;         // 采样的阶段次数
+    unsigned long long cycles;
+    unsigned long long instructions;
+    unsigned long long llc_misses;    // 末级缓存读未命中，不支持时为 0
+    unsigned long long branch_misses;
+} TRT_SEG_STAGE_PERF;
+
+typedef struct TRT_SEG_PERF_COUNTERS {
+    TRT_SEG_STAGE_PERF stages[TRT_SEG_NUM_STAGES]; // 以 TRT_SEG_STAGE 为下标
+} TRT_SEG_PERF_COUNTERS;
+
+// 一个连通域 (8 邻域) 的统计，坐标为原始图像分辨率
+typedef struct TRT_SEG_COMPONENT {
+    int class_id;           // 连通域的像素值：类别索引，二值掩码时为 255
+    long long area;         // 像素数
+    int x, y;               // 外接矩形左上角
+    int width, height;      // 外接矩形大小
+    double centroid_x;      // 质心
+    double centroid_y;
+} TRT_SEG_COMPONENT;
+
+// 一条轮廓环，点存放在调用方提供的坐标数组中
+typedef struct TRT_SEG_POLYGON {
+    int class_id;     // 区域的像素值：类别索引，二值掩码时为 255
+    int parent;       // 外轮廓为 -1；孔洞为所属外轮廓的下标
+    int first_point;  // 第一个点在坐标数组中的序号 (坐标为 points[2 * first_point], points[2 * first_point + 1])
+    int num_points;   // 点数，首尾不重复
+} TRT_SEG_POLYGON;
+
 /**
  * @brief 创建一个分割器实例
  * @return 返回一个句柄，后续操作都需要这个句柄。如果失败则返回 nullptr。
@@ -30,16 +162,131 @@ TRT_SEG_API TRT_SEG_HANDLE create_segmentation_instance();
  */
 TRT_SEG_API void destroy_segmentation_instance(TRT_SEG_HANDLE handle);
 
+/**
+ * @brief 选择推理后端 (默认 TRT_SEG_BACKEND_TENSORRT)，必须在 init_engine 之前调用
+ * @details 预处理、调度、流水线和后处理对所有后端都相同。未启用 TensorRT 编译的库
+ *          只能使用 TRT_SEG_BACKEND_OPENCV_CPU
+ * @return 0 表示成功, 其他值表示失败
+ */
+TRT_SEG_API int set_backend(TRT_SEG_HANDLE handle, int backend);
+
 /**
  * @brief 初始化 TensorRT 引擎
+ * @details 引擎文件通过内存映射读取并直接反序列化，不会先复制到一块完整的内存中。
+ *          同一进程内加载同一个引擎文件的多个句柄共享一份反序列化后的引擎 (权重只占一份显存)，
+ *          每个句柄只创建自己的执行上下文；最后一个句柄销毁时引擎随之释放。
  * @param handle 实例句柄
- * @param engine_path .engine 模型的绝对路径
+ * @param engine_path .engine 模型的绝对路径；CPU 后端为 .onnx 模型
  * @return 0 表示成功, 其他值表示失败
  */
 TRT_SEG_API int init_engine(TRT_SEG_HANDLE handle, const char* engine_path);
 
+/**
+ * @brief 从内存中的序列化引擎初始化 (例如嵌入在调用方自己的容器格式中的引擎)
+ * @param handle 实例句柄
+ * @details 不经过引擎缓存，每次调用都会反序列化一份新的引擎
+ * @param engine_data 序列化引擎数据，函数返回后即可释放
+ * @param engine_size 数据字节数
+ * @return 0 表示成功, 其他值表示失败
+ */
+TRT_SEG_API int init_engine_from_memory(TRT_SEG_HANDLE handle, const void* engine_data, size_t engine_size);
+
+/**
+ * @brief 设置执行上下文池的大小 (默认 1)
+ * @details 所有上下文共享同一个反序列化的引擎，每个上下文拥有独立的缓冲区，
+ *          因此同一个句柄上的 run_inference 可以被最多 num_contexts 个线程同时执行，
+ *          多出的调用会等待空闲的上下文。必须在 init_engine 之前调用。
+ * @param handle 实例句柄
+ * @param num_contexts 上下文数量，必须 >= 1
+ * @return 0 表示成功, 其他值表示失败 (参数无效或引擎已初始化)
+ */
+TRT_SEG_API int set_context_pool_size(TRT_SEG_HANDLE handle, int num_contexts);
+
+/**
+ * @brief 开启或关闭动态批处理
+ * @details 开启后，多个线程同时调用的 run_inference / run_inference_buffer 请求会进入队列，
+ *          调度器把它们合并为一个批次 (最多 max_batch_size 张，或最早的请求已等待 max_delay_us 微秒)，
+ *          以一次引擎调用执行后再把各自的掩码分发回调用方。批大小会被限制在引擎优化配置允许的最大批次内。
+ *          必须在 init_engine 之后、且没有推理正在进行时调用。
+ * @param handle 实例句柄
+ * @param max_batch_size 最大批大小，<= 1 表示关闭批处理
+ * @param max_delay_us 请求在队列中等待凑批的最长时间 (微秒)
+ * @return 0 表示成功, 其他值表示失败
+ */
+TRT_SEG_API int set_dynamic_batching(TRT_SEG_HANDLE handle, int max_batch_size, int max_delay_us);
+
+/**
+ * @brief 打开一个线扫相机的流式会话
+ * @details 调用方通过 stream_push_rows 不断推入宽度为 width 的像素行，会话在滑动窗口中每凑满 256 行
+ *          就推理一次 (宽度超过 2048 时横向分块)，相邻窗口重叠 overlap_rows 行并按线性权重融合。
+ *          已经确定的掩码行 (0/255) 通过 stream_pop_mask_rows 取出，从推入到可取出最多延迟一个窗口。
+ *          stream_push_rows / stream_finish 必须在同一个线程上调用，推理在该线程上同步完成；
+ *          stream_pop_mask_rows 可以在其他线程上调用。会话必须在销毁实例之前关闭。
+ * @param handle 已经 init_engine 的实例句柄
+ * @param width 每行的像素数
+ * @param pixel_format TRT_SEG_PIXEL_FORMAT
+ * @param overlap_rows 相邻窗口重叠的行数，0 <= overlap_rows < 256
+ * @return 会话句柄，失败时返回 NULL
+ */
+TRT_SEG_API TRT_SEG_STREAM stream_open(TRT_SEG_HANDLE handle, int width, int pixel_format, int overlap_rows);
+
+/**
+ * @brief 推入 num_rows 行像素 (复制到会话内部，返回后即可复用缓冲区)
+ * @param stride 每行的字节数
+ * @return 0 表示成功, 其他值表示失败 (推理失败或会话已经 finish)
+ */
+TRT_SEG_API int stream_push_rows(TRT_SEG_STREAM stream, const uint8_t* pixels, int num_rows, int stride);
+
+/**
+ * @brief 取出最多 max_rows 行已经确定的掩码，每行 width 字节
+ * @return 实际取出的行数 (可能为 0)，参数错误时返回 -1
+ */
+TRT_SEG_API int stream_pop_mask_rows(TRT_SEG_STREAM stream, uint8_t* mask_out, int max_rows, int mask_stride);
+
+/**
+ * @brief 输入结束：最后不足一个窗口的行补边后推理，之后所有掩码行都可以取出
+ * @return 0 表示成功, 其他值表示失败
+ */
+TRT_SEG_API int stream_finish(TRT_SEG_STREAM stream);
+
+/**
+ * @brief 关闭会话并释放资源；未取出的掩码行被丢弃
+ */
+TRT_SEG_API void stream_close(TRT_SEG_STREAM stream);
+
+/**
+ * @brief 开启或关闭分块推理
+ * @details 开启后，宽或高超过模型输入 (2048x256) 的图像不再整体缩放，而是按原始分辨率切成相互重叠的
+ *          模型输入大小的分块 (图像某一方向小于分块时在该方向补边)，分块分批并行推理，
+ *          重叠区域的 logits 按线性权重融合后再做 argmax。累加缓冲区只保留一行分块的高度，
+ *          内存占用与图像高度无关。作用于 run_inference / run_inference_buffer 以及流水线和批量接口。
+ *          不能与推理并发调用。
+ * @param handle 实例句柄
+ * @param enable 非 0 表示开启
+ * @param overlap_pixels 相邻分块至少重叠的像素数，0 <= overlap_pixels < 256
+ * @return 0 表示成功, 其他值表示失败
+ */
+TRT_SEG_API int set_tiling(TRT_SEG_HANDLE handle, int enable, int overlap_pixels);
+
+/**
+ * @brief 设置保持宽高比的输入尺寸 (letterbox 模式)
+ * @details 默认每张图像都被拉伸到 2048x256。设置输入桶后，每张图像选用能以原始大小放下它的面积最小的桶
+ *          (不放大)；都放不下时选用缩放比例最大的桶并按比例缩小。图像位于输入的左上角，其余部分填充均值颜色，
+ *          输出裁掉填充部分后再放大到原始分辨率。动态批处理中选中不同桶的请求分别执行。
+ *          每个桶必须在引擎的输入范围内 (优化配置文件 0)；分块和流式接口不受影响。
+ *          必须在初始化之后调用，不能与推理并发调用；重新初始化后需要重新设置
+ * @param handle 实例句柄
+ * @param sizes count 对 (宽, 高)
+ * @param count 桶的数量；0 表示恢复为拉伸模式
+ * @return 0 表示成功, 其他值表示失败
+ */
+TRT_SEG_API int set_shape_buckets(TRT_SEG_HANDLE handle, const int* sizes, int count);
+
 /**
  * @brief 对输入的图像执行语义分割
+ * @details 线程安全：可以在同一个句柄上从多个线程并发调用。
+ *          大尺寸 JPEG 以 1/2、1/4 或 1/8 的 DCT 缩放直接解码，只要结果仍不小于模型实际采样的分辨率
+ *          (模型输入大小，或 letterbox 所选的内容大小；分块模式下不缩小)，掩码仍按原始分辨率输出
  * @param handle 实例句柄
  * @param image_path 输入图像的绝对路径
  * @param output_mask_path 输出分割掩码图像的保存路径
@@ -47,6 +294,261 @@ TRT_SEG_API int init_engine(TRT_SEG_HANDLE handle, const char* engine_path);
  */
 TRT_SEG_API int run_inference(TRT_SEG_HANDLE handle, const char* image_path, const char* output_mask_path);
 
+/**
+ * @brief 与 run_inference 相同，但显式指定掩码文件的格式 (不看扩展名)
+ * @details 除 PNG 外，后处理直接生成原始分辨率的 1 bit 位图再编码，不经过 8 bit 掩码，也没有 zlib 压缩
+ * @param mask_format TRT_SEG_MASK_FORMAT 之一
+ * @return 0 表示成功, 其他值表示失败
+ */
+TRT_SEG_API int run_inference_ex(TRT_SEG_HANDLE handle, const char* image_path, const char* output_mask_path, int mask_format);
+
+/**
+ * @brief 与 run_inference 相同，但输入是内存中的编码图像 (JPEG、PNG 等文件内容)，掩码格式由输出路径的扩展名决定
+ * @param data 编码图像的数据，调用返回后即可释放
+ * @param size 数据的字节数
+ * @return 0 表示成功, 其他值表示失败
+ */
+TRT_SEG_API int run_inference_encoded(TRT_SEG_HANDLE handle, const void* data, size_t size, const char* output_mask_path);
+
+/**
+ * @brief 对内存中的图像执行语义分割，结果直接写入调用方的缓冲区
+ * @details 不做任何编码/解码和文件读写，也不复制输入像素。线程安全，同 run_inference。
+ * @param handle 实例句柄
+ * @param pixels 输入像素，pixel_format 指定的交错排列
+ * @param width 图像宽度
+ * @param height 图像高度
+ * @param stride 输入每行的字节数 (>= width * 通道数)
+ * @param pixel_format TRT_SEG_PIXEL_FORMAT 之一
+ * @param mask_out 输出掩码，width x height 个字节，前景为 255，背景为 0
+ * @param mask_stride 输出每行的字节数 (>= width)
+ * @return 0 表示成功, 其他值表示失败
+ */
+TRT_SEG_API int run_inference_buffer(TRT_SEG_HANDLE handle, const uint8_t* pixels, int width, int height, int stride,
+                                     int pixel_format, uint8_t* mask_out, int mask_stride);
+
+/**
+ * @brief 与 run_inference_buffer 相同，但输出每个像素的类别索引 (标签图) 而不是二值掩码
+ * @param labels_out 输出标签图，width x height 个字节，值为类别索引 (模型类别数需 <= 256，否则返回失败)
+ * @param labels_stride 输出每行的字节数 (>= width)
+ * @return 0 表示成功, 其他值表示失败
+ */
+TRT_SEG_API int run_inference_buffer_labels(TRT_SEG_HANDLE handle, const uint8_t* pixels, int width, int height, int stride,
+                                            int pixel_format, uint8_t* labels_out, int labels_stride);
+
+/**
+ * @brief 同时输出类别索引图和每个像素的置信度 (获胜类别的 softmax 概率)
+ * @details softmax 与 argmax 在同一遍中完成 (向量化，exp 为多项式近似)，不需要为概率再跑一次模型；
+ *          两者都以原始分辨率写出。模型输出类别索引图时置信度为 1.0。分块模式下不可用。线程安全，同 run_inference
+ * @param labels_out 输出标签图，width x height 个字节，值为类别索引
+ * @param labels_stride 标签图每行的字节数 (>= width)
+ * @param confidence_out 输出置信度，格式由 confidence_format 指定
+ * @param confidence_stride 置信度每行的字节数 (>= width * 每像素字节数)
+ * @param confidence_format TRT_SEG_CONFIDENCE_FORMAT 之一
+ * @return 0 表示成功, 其他值表示失败
+ */
+TRT_SEG_API int run_inference_buffer_confidence(TRT_SEG_HANDLE handle, const uint8_t* pixels, int width, int height,
+                                                int stride, int pixel_format, uint8_t* labels_out, int labels_stride,
+                                                void* confidence_out, int confidence_stride, int confidence_format);
+
+/**
+ * @brief 与 run_inference_buffer 相同，但不放大：以模型输出分辨率返回掩码
+ * @details 原始分辨率与掩码分辨率之比即为缩放因子 (width / mask_width, height / mask_height)，
+ *          调用方可以按需在自己的坐标系中换算，省去整张原始分辨率掩码的写入
+ * @param mask_out 输出掩码，紧密排列 (每行 mask_width 字节)
+ * @param mask_capacity mask_out 的字节数
+ * @param mask_width 输出掩码的宽度
+ * @param mask_height 输出掩码的高度；容量不足时仍会写入所需的尺寸并返回 -1
+ * @return 0 表示成功, 其他值表示失败
+ */
+TRT_SEG_API int run_inference_buffer_lowres(TRT_SEG_HANDLE handle, const uint8_t* pixels, int width, int height, int stride,
+                                            int pixel_format, uint8_t* mask_out, int mask_capacity, int* mask_width,
+                                            int* mask_height);
+
+/**
+ * @brief 与 run_inference 相同，并同时返回前景掩码的连通域统计
+ * @details 连通域在后处理生成每一行掩码时用基于行程的并查集同步标记，不需要再读回掩码；
+ *          缩放后的统计按最近邻放大的范围直接累加，与在保存的掩码上标记的结果完全一致。
+ *          结果按外接矩形的 (y, x) 排序
+ * @param min_area 面积小于该值的连通域被丢弃
+ * @param components 输出数组，最多写入 capacity 项 (capacity 为 0 时可为 NULL)
+ * @param count 返回连通域的总数；大于 capacity 时只写入前 capacity 项
+ * @return 0 表示成功, 其他值表示失败
+ */
+TRT_SEG_API int run_inference_components(TRT_SEG_HANDLE handle, const char* image_path, const char* output_mask_path,
+                                         int min_area, TRT_SEG_COMPONENT* components, int capacity, int* count);
+
+/**
+ * @brief 与 run_inference_buffer / run_inference_buffer_labels 相同，并同时返回连通域统计
+ * @param per_class 非 0 时 mask_out 为类别索引图，每个类别分别标记连通域；否则为二值掩码
+ * @param min_area, components, capacity, count 同 run_inference_components
+ * @return 0 表示成功, 其他值表示失败
+ */
+TRT_SEG_API int run_inference_buffer_components(TRT_SEG_HANDLE handle, const uint8_t* pixels, int width, int height,
+                                                int stride, int pixel_format, int per_class, uint8_t* mask_out,
+                                                int mask_stride, int min_area, TRT_SEG_COMPONENT* components,
+                                                int capacity, int* count);
+
+/**
+ * @brief 设置轮廓输出 (.geojson / .poly) 的简化精度
+ * @details 轮廓在模型分辨率的掩码上提取后用 Douglas-Peucker 算法简化，坐标再换算到原始图像。
+ *          不能与推理并发调用
+ * @param epsilon 允许的最大偏差，单位为模型分辨率的像素 (默认 1.0)；0 表示不简化
+ * @return 0 表示成功, 其他值表示失败
+ */
+TRT_SEG_API int set_polygon_epsilon(TRT_SEG_HANDLE handle, double epsilon);
+
+/**
+ * @brief 对内存中的图像执行语义分割，只返回区域轮廓，不生成原始分辨率的栅格掩码
+ * @details 轮廓在模型分辨率的结果上提取 (外轮廓 + 孔洞)，按 epsilon 简化后换算到原始图像坐标 (像素中心)；
+ *          简化后少于 3 个点的碎片被丢弃。线程安全，同 run_inference
+ * @param per_class 非 0 时每个类别分别提取；否则提取前景 (类别 > 0) 的轮廓
+ * @param epsilon 简化精度，单位为模型分辨率的像素；0 表示不简化
+ * @param polygons 输出的轮廓环，最多 polygon_capacity 项
+ * @param points 输出的坐标 (x, y 交替)，最多 point_capacity 个点
+ * @param polygon_count 返回轮廓环的总数
+ * @param point_count 返回点的总数；任一容量不足时仍返回所需的数量，并返回 -1
+ * @return 0 表示成功, 其他值表示失败
+ */
+TRT_SEG_API int run_inference_buffer_polygons(TRT_SEG_HANDLE handle, const uint8_t* pixels, int width, int height,
+                                              int stride, int pixel_format, int per_class, double epsilon,
+                                              TRT_SEG_POLYGON* polygons, int polygon_capacity, float* points,
+                                              int point_capacity, int* polygon_count, int* point_count);
+
+/**
+ * @brief 与 run_inference_buffer 相同，但输出每像素 1 bit 的前景位图
+ * @details 每字节 8 个像素，高位对应左侧像素 (与 PBM 相同)，每行末尾不足 8 个像素的位补 0。
+ *          后处理直接打包，不生成 8 bit 掩码
+ * @param bits_out 输出位图，height 行
+ * @param bits_stride 输出每行的字节数 (>= (width + 7) / 8)
+ * @return 0 表示成功, 其他值表示失败
+ */
+TRT_SEG_API int run_inference_buffer_packed(TRT_SEG_HANDLE handle, const uint8_t* pixels, int width, int height, int stride,
+                                            int pixel_format, uint8_t* bits_out, int bits_stride);
+
+/**
+ * @brief 启动流水线模式
+ * @details 解码+预处理、推理、后处理+编码分别在三个专用线程上运行，阶段之间通过有界无锁队列连接，
+ *          使 CPU 工作与推理重叠；文件读取和掩码写出另由 I/O 线程池完成。每个在途请求占用一个执行上下文，建议先用 set_context_pool_size
+ *          设置至少 3 个上下文。必须在 init_engine 之后调用；再次调用会先等待并关闭已有的流水线。
+ * @param handle 实例句柄
+ * @param queue_depth 每个阶段输入队列的容量
+ * @return 0 表示成功, 其他值表示失败
+ */
+TRT_SEG_API int pipeline_start(TRT_SEG_HANDLE handle, int queue_depth);
+
+/**
+ * @brief 向流水线提交一个请求，立即返回 (第一个队列满时阻塞)
+ * @return 0 表示已提交, 其他值表示失败 (流水线未启动)
+ */
+TRT_SEG_API int pipeline_submit(TRT_SEG_HANDLE handle, const char* image_path, const char* output_mask_path);
+
+/**
+ * @brief 等待所有已提交的请求完成
+ * @return 自上次 pipeline_flush 以来失败的请求数 (>= 0)；流水线未启动时返回 -1
+ */
+TRT_SEG_API int pipeline_flush(TRT_SEG_HANDLE handle);
+
+/**
+ * @brief 处理完所有已提交的请求后关闭流水线
+ */
+TRT_SEG_API void pipeline_stop(TRT_SEG_HANDLE handle);
+
+/**
+ * @brief 批量处理一组图像
+ * @details 在内部的流水线上运行：后续图像的读取/解码在 I/O 线程上提前进行，
+ *          掩码的编码和写出也在 I/O 线程上异步完成，推理期间不等待磁盘。
+ *          与 pipeline_start 启动的流水线相互独立；建议用 set_context_pool_size 设置至少 3 个上下文。
+ * @param handle 实例句柄
+ * @param image_paths 输入图像路径数组，长度为 count
+ * @param output_mask_paths 输出掩码路径数组，长度为 count
+ * @param count 图像数量
+ * @param statuses 可为 NULL；否则按下标写入每一项的结果 (0 表示成功)
+ * @return 失败的项数 (>= 0)；参数无效时返回 -1
+ */
+TRT_SEG_API int run_inference_batch(TRT_SEG_HANDLE handle, const char** image_paths, const char** output_mask_paths,
+                                    int count, int* statuses);
+
+/**
+ * @brief 按清单文件批量处理
+ * @details 清单为文本文件，每行一项："输入路径<TAB>输出路径"；空行和以 # 开头的行被忽略。
+ *          执行方式与 run_inference_batch 相同，格式错误的行和失败的项都会输出到 stderr
+ * @return 失败的项数 (包括格式错误的行)；清单无法读取时返回 -1
+ */
+TRT_SEG_API int run_inference_manifest(TRT_SEG_HANDLE handle, const char* manifest_path);
+
+/**
+ * @brief 查询流水线各阶段的队列深度和占用率
+ * @return 0 表示成功, 其他值表示失败 (流水线未启动)
+ */
+TRT_SEG_API int get_pipeline_stats(TRT_SEG_HANDLE handle, TRT_SEG_PIPELINE_STATS* stats);
+
+/**
+ * @brief 查询设备/主机缓冲区池的分配次数、复用次数和高水位
+ * @param handle 实例句柄
+ * @param stats 输出统计信息
+ * @return 0 表示成功, 其他值表示失败
+ */
+TRT_SEG_API int get_buffer_pool_stats(TRT_SEG_HANDLE handle, TRT_SEG_BUFFER_STATS* stats);
+
+
+/**
+ * @brief 查询各阶段的延迟分布 (自实例创建或上次 reset_inference_stats 以来)
+ * @details 计时始终开启，每个阶段的记录只是几次原子加法，对推理延迟没有可测量的影响
+ * @param handle 实例句柄
+ * @param stats 输出统计信息
+ * @return 0 表示成功, 其他值表示失败
+ */
+TRT_SEG_API int get_inference_stats(TRT_SEG_HANDLE handle, TRT_SEG_INFERENCE_STATS* stats);
+
+/**
+ * @brief 清空延迟统计；与正在进行的推理并发调用时，少量样本可能丢失
+ */
+TRT_SEG_API void reset_inference_stats(TRT_SEG_HANDLE handle);
+
+/**
+ * @brief 开启/关闭各阶段的硬件性能计数器 (cycles、instructions、LLC 未命中、分支预测失败)
+ * @details 仅 Linux，通过 perf_event_open 为每个执行阶段的线程打开一组计数器，
+ *          需要 perf_event_paranoid <= 2 (或 CAP_PERFMON)。每个阶段多两次 read 系统调用，只用于分析。
+ *          预处理和后处理在 OpenCV 线程池上并行的部分，由每个工作线程在并行体内各自读取计数并累加到该阶段，
+ *          因此这两个阶段的计数是所有参与线程之和 (每阶段每个并行块多两次 read)。
+ *          其他情况下计数只包含执行该阶段的线程，例如开启动态批处理时请求总耗时阶段不包含调度器线程上的推理
+ * @param handle 实例句柄
+ * @param enable 非 0 表示开启
+ * @return 0 表示成功, 计数器不可用时返回 -1
+ */
+TRT_SEG_API int enable_perf_counters(TRT_SEG_HANDLE handle, int enable);
+
+/**
+ * @brief 查询各阶段的硬件计数器累计值 (随 reset_inference_stats 清空)
+ * @param handle 实例句柄
+ * @param counters 输出
+ * @return 0 表示成功, 其他值表示失败
+ */
+TRT_SEG_API int get_perf_counters(TRT_SEG_HANDLE handle, TRT_SEG_PERF_COUNTERS* counters);
+
+/**
+ * @brief 开始记录每个请求在各阶段的 span，可导出为 Chrome trace JSON (chrome://tracing 或 Perfetto 打开)
+ * @details 每个线程写入自己的环形缓冲区，写满后覆盖最旧的事件；未开启时开销只是一次原子读。
+ *          span 的 args.request 为请求 ID，同一请求在不同线程上的 span 可据此关联
+ * @param handle 实例句柄
+ * @param events_per_thread 每个线程保留的最近事件数 (> 0)
+ * @param dump_on_destroy_path 非空时在 destroy_segmentation_instance 中自动导出到该路径
+ * @return 0 表示成功, 其他值表示失败
+ */
+TRT_SEG_API int enable_tracing(TRT_SEG_HANDLE handle, int events_per_thread, const char* dump_on_destroy_path);
+
+/**
+ * @brief 停止记录；已记录的事件保留，仍可导出
+ */
+TRT_SEG_API void disable_tracing(TRT_SEG_HANDLE handle);
+
+/**
+ * @brief 将当前缓冲区中的事件导出为 Chrome trace JSON，可以在推理进行时调用
+ * @param handle 实例句柄
+ * @param path 输出文件路径
+ * @return 0 表示成功, 其他值表示失败
+ */
+TRT_SEG_API int dump_trace(TRT_SEG_HANDLE handle, const char* path);
 
 #ifdef __cplusplus
 }
@@ -8,19 +8,69 @@
 #include <numeric>
 #include <functional>
 
-#include "NvInfer.h"
-#include "NvInferRuntime.h"
-#include <cuda_runtime.h>
-
 #include <opencv2/opencv.hpp>
 
+#include "argmax.h"
+#include "batch_scheduler.h"
+#include "buffer_pool.h"
+#include "connected_components.h"
+#include "image_decode.h"
+#include "inference_backend.h"
+#include "inference_stats.h"
+#include "mask_encoding.h"
+#include "mask_polygons.h"
+#include "pipeline.h"
+#include "preprocess.h"
+#include "resource_pool.h"
+#include "stream_session.h"
+#include "tile_stitcher.h"
+
+
+// 一个执行上下文及其预处理状态。
+// 多个 slot 共享同一个加载好的模型，互不干扰，因此可以并发推理。
+struct InferenceSlot {
+    // 拥有自己的输入/输出缓冲区，在多次 run() 之间保留，只在形状变大时重新分配
+    std::unique_ptr<BackendContext> context;
+
+    // 最近一次 prepare() 设置的输入形状
+    TensorShape input_shape;
+
+    PreprocessEngine preprocess_engine;
+};
+
+// 模型输出中一张图像的布局：类别分数 (C 个平面) 或类别索引图 (num_classes = 1)。
+// letterbox 时 height x width 只是左上角的有效区域，行距和平面大小仍按整个输出计算
+struct OutputLayout {
+    int num_classes = 0;
+    int height = 0;
+    int width = 0;
+    size_t row_stride = 0; // 相邻两行的元素数
+    size_t plane = 0;      // 相邻两个类别平面的元素数
+};
+
+// 一次推理请求；动态批处理时多个请求合并为一次引擎调用
+struct BatchJob {
+    const ImageView* image = nullptr;
+    ArgmaxOutput mode = ArgmaxOutput::kForegroundMask;
+    // 为空时按模型输出分辨率分配；已经分配 (例如包装调用方的缓冲区或原始图像大小) 时，
+    // 后处理以最近邻直接写成该分辨率，不产生中间图像
+    cv::Mat* mask = nullptr;
+    // 非空时后处理以 packed 的大小直接写出 1 bit 前景位图，不经过 8 bit 掩码，mask 不会被写入
+    PackedMask* packed = nullptr;
+    // 非空时后处理在生成每一行的同时标记连通域，统计写入这里 (目标分辨率)
+    ComponentSet* components = nullptr;
+    // 非空时同一遍中输出获胜类别的 softmax 概率，大小与 mask 相同：CV_8UC1 为 0~255 量化，
+    // CV_16UC1 存放 fp16；为空时按 CV_8UC1 分配。模型输出类别索引图时填 1.0
+    cv::Mat* confidence = nullptr;
+    // 为 true 时图像已经是模型输入大小 (分块)，不做 letterbox
+    bool fixed_input = false;
+    // 由 prepare 填写：图像在模型输入中的位置，finish 据此裁掉 letterbox 的填充
+    InputGeometry geometry;
+    int status = -1;
+    uint64_t request_id = 0; // 用于 trace 中关联同一请求在不同线程上的 span
 
-class Logger : public nvinfer1::ILogger {
-    void log(Severity severity, const char* msg) noexcept override {
-        // if (severity <= Severity::kWARNING) {
-        //     std::cout << msg << std::endl;
-        // }
-    }
+    // 非空时 finish 把该请求的 logits (及整个批次的输出形状) 交给 sink，不做 argmax，mask 不会被写入
+    std::function<void(const float* logits, const TensorShape& shape)> sink;
 };
 
 class TRTSegmentation {
@@ -28,26 +78,178 @@ public:
     TRTSegmentation() = default;
     ~TRTSegmentation();
 
-    int init(const std::string& engine_path);
+    // 执行上下文的数量和推理后端 (默认 TensorRT)，必须在 init() 之前设置
+    int set_num_contexts(int num_contexts);
+    int set_backend(BackendKind kind);
+
+    // TensorRT 后端通过进程级缓存 EngineRegistry 获取引擎：同一个文件只反序列化一次
+    int init(const std::string& model_path);
+    // 从调用方内存中的模型初始化，返回后调用方即可释放该内存
+    int init_from_memory(const void* model_data, size_t model_size);
+
+    // 开启动态批处理：并发的请求在队列中等待最多 max_delay_us 微秒，
+    // 凑成最多 max_batch_size 张图像后一起执行。max_batch_size <= 1 表示关闭。
+    // 必须在 init() 之后、且没有推理正在进行时调用
+    int set_dynamic_batching(int max_batch_size, int max_delay_us);
+
+    // 分块模式：大于模型输入 (kInputWidth x kInputHeight) 的图像按原始分辨率切成相互重叠 overlap 像素的分块，
+    // 分批推理后加权拼接 logits 再做 argmax，而不是整体缩放到模型输入大小。
+    // run() / run_buffer()、流水线和批量接口都会分块；分块的图像在流水线的编码阶段推理，不占用预处理/推理阶段
+    int set_tiling(bool enable, int overlap);
+
+    // 轮廓输出 (.geojson / .poly) 的简化精度，单位为模型分辨率的像素；0 表示不简化。
+    // 不能与推理并发调用
+    int set_polygon_epsilon(double epsilon);
+
+    // 保持宽高比的 letterbox 模式：每张图像选用 buckets 中最小的能放下它的输入尺寸 (见 letterbox_geometry)，
+    // 输出裁掉填充后再放大到原始分辨率。为空时恢复为拉伸到 kInputWidth x kInputHeight。
+    // 每个桶必须在引擎的输入范围内；分块和流式会话不受影响。
+    // 必须在 init() 之后、且没有推理正在进行时调用；重新 init() 会清空
+    int set_shape_buckets(const std::vector<ShapeBucket>& buckets);
+
+    // 打开一个流式会话 (线扫相机)，每行 width 个像素；overlap 为相邻窗口重叠的行数 (横向分块同样使用)。
+    // 必须在 init() 之后调用，会话必须先于本对象销毁
+    std::unique_ptr<StreamSession> open_stream(int width, PixelFormat format, int overlap, ArgmaxOutput mode);
+
+    // 流水线模式：submit 立即返回，解码/推理/编码在三个专用线程上重叠执行。
+    // 必须在 init() 之后调用
+    int start_pipeline(int queue_depth);
+    int pipeline_submit(const std::string& image_path, const std::string& output_mask_path);
+    // 等待所有已提交的请求完成，返回失败的请求数；未开启流水线时返回 -1
+    int pipeline_flush();
+    int pipeline_stats(PipelineStageStats out[kNumPipelineStages], PipelineStageStats& io) const;
+    void stop_pipeline();
+
+    // 批量处理：在一个独立的流水线上处理 count 对输入/输出路径，文件读取和写出在 I/O 线程上
+    // 与推理重叠。statuses (可为空) 按下标返回每一项的结果，返回失败的项数
+    int run_batch(const char* const* image_paths, const char* const* output_mask_paths, int count, int* statuses);
+    // 清单文件每行一项："输入路径<TAB>输出路径"，空行和以 # 开头的行被忽略。
+    // 返回失败的项数；清单无法读取时返回 -1
+    int run_manifest(const std::string& manifest_path);
+
+    // 所有执行上下文的缓冲区池统计之和
+    void buffer_stats(BufferPoolStats& device, BufferPoolStats& host) const;
+
+    // 各阶段的延迟分布 (自创建或上次 reset 以来)
+    void inference_stats(LatencySummary out[kNumInferenceStages]) const;
+    void reset_inference_stats();
+
+    // 各阶段的硬件计数器累计值 (仅 Linux，需要 perf_event_open 权限)；统计随 reset_inference_stats 清空
+    int enable_perf_counters(bool enable);
+    void perf_counters(PerfSummary out[kNumInferenceStages]) const;
+
+    // 开始记录各阶段的 span (Chrome trace 格式)。dump_on_destroy_path 非空时在句柄销毁时自动导出
+    int start_trace(size_t events_per_thread, const std::string& dump_on_destroy_path);
+    void stop_trace();
+    int dump_trace(const std::string& path) const;
+
+    // 以下接口可以从多个线程并发调用；每次调用占用池中的一个执行上下文
+    // 输出格式由 output_mask_path 的扩展名决定 (见 mask_format_for_path)
     int run(const std::string& image_path, const std::string& output_mask_path);
+    // 指定输出格式；除 PNG 外后处理直接生成 1 bit 位图再编码，不经过 8 bit 掩码
+    // components 非空时同时返回前景掩码的连通域统计 (轮廓格式不支持)
+    int run(const std::string& image_path, const std::string& output_mask_path, MaskFormat format,
+            ComponentSet* components = nullptr);
+
+    // 从内存中的编码图像 (JPEG/PNG 等) 推理，输出同 run()
+    int run_encoded(const void* data, size_t size, const std::string& output_mask_path, MaskFormat format);
+
+    // 直接使用调用方的像素缓冲区，结果以原始分辨率写入 mask_out (不做任何文件读写)
+    // components 非空时同时返回连通域统计 (kLabels 时按类别分别标记)
+    int run_buffer(const ImageView& image, ArgmaxOutput mode, uint8_t* mask_out, size_t mask_stride,
+                   ComponentSet* components = nullptr);
+    // 不放大：以模型输出分辨率写入 mask_out (紧密排列，容量 capacity 字节)，并返回该分辨率
+    int run_buffer_lowres(const ImageView& image, ArgmaxOutput mode, uint8_t* mask_out, size_t capacity,
+                          int& mask_width, int& mask_height);
+    // 以原始分辨率写出 1 bit 前景位图 (高位在前)，每行 bits_stride 字节 (>= ceil(width / 8))
+    int run_buffer_packed(const ImageView& image, uint8_t* bits_out, size_t bits_stride);
+    // 同 run_buffer，并以原始分辨率输出每个像素的置信度 (获胜类别的 softmax 概率)：
+    // half 为 false 时每像素 1 字节 (0~255)，为 true 时为 fp16。分块模式下不可用
+    int run_buffer_confidence(const ImageView& image, ArgmaxOutput mode, uint8_t* mask_out, size_t mask_stride,
+                              void* confidence_out, size_t confidence_stride, bool half);
+    // 不生成栅格掩码，返回原始坐标的区域轮廓 (kLabels 时按类别分别提取)
+    int run_buffer_polygons(const ImageView& image, ArgmaxOutput mode, double epsilon, std::vector<PolygonRing>& rings);
 
 private:
-    void preprocess(const cv::Mat& image);
-    void postprocess(cv::Mat& mask, const nvinfer1::Dims& dims);
-
-    Logger logger_;
-    std::unique_ptr<nvinfer1::IRuntime> runtime_;
-    std::unique_ptr<nvinfer1::ICudaEngine> engine_;
-    std::unique_ptr<nvinfer1::IExecutionContext> context_;
-
-    std::vector<void*> buffers_;
-    nvinfer1::Dims input_dims_;
-    nvinfer1::Dims output_dims_;
-    int input_binding_index_ = -1;
-    int output_binding_index_ = -1;
-    std::string input_tensor_name_;
-    std::string output_tensor_name_;
-
-    std::vector<float> host_input_;
-    std::vector<float> host_output_;
+    friend class SegmentationPipeline;
+    friend class StreamSession;
+
+    // 在加载好的模型上创建本句柄的执行上下文
+    int attach(std::unique_ptr<InferenceBackend> backend);
+
+    // 解码：JPEG 以 DCT 缩放直接解码到不小于 decode_target 的最小分辨率 (1/2、1/4、1/8)，
+    // 其他格式完整解码。image.width/height 始终为原始尺寸。线程安全。
+    // decode_file 把整个文件读入缓冲区后解码，失败时返回 -1 且不输出错误信息 (由调用方输出)
+    void decode(const uint8_t* data, size_t size, DecodedImage& image) const;
+    int decode_file(const std::string& path, DecodedImage& image) const;
+    // 模型实际采样的分辨率：拉伸时为模型输入大小，letterbox 时为所选桶中的内容大小，分块时为原始大小
+    void decode_target(int width, int height, int& min_width, int& min_height) const;
+    // 解码之后的 run()：按原始尺寸输出掩码、位图或轮廓
+    int run_decoded(const DecodedImage& image, const std::string& output_mask_path, MaskFormat format,
+                    ComponentSet* components);
+
+    // 推理并生成掩码 (开启动态批处理时经由调度器)，分辨率见 BatchJob::mask
+    int infer(const ImageView& image, ArgmaxOutput mode, cv::Mat& output_mask, ComponentSet* components = nullptr);
+    int infer(const ImageView& image, ArgmaxOutput mode, cv::Mat& output_mask, cv::Mat& confidence);
+    int infer(const ImageView& image, PackedMask& packed, ComponentSet* components);
+    int infer(BatchJob& job);
+    // 生成前景位图，packed 为空时按 image 大小分配；分块模式下先生成 8 bit 掩码再打包。
+    // slot 见 infer_tiled
+    int infer_packed(const ImageView& image, PackedMask& packed, ComponentSet* components = nullptr,
+                     InferenceSlot* slot = nullptr);
+    // 在模型分辨率的输出上提取轮廓 (分块模式下在原始分辨率的掩码上提取)，坐标换算到 width x height
+    // (原始图像大小，缩小解码时大于 image)
+    int infer_polygons(const ImageView& image, ArgmaxOutput mode, double epsilon, int width, int height,
+                       std::vector<PolygonRing>& rings);
+    // 分块推理，直接生成原始分辨率的掩码；mask 必须已经是 image 大小的 CV_8UC1。
+    // slot 为空时各分块批次从池中借用上下文并行执行；调用方已经持有一个上下文时 (流水线) 传入它，
+    // 所有批次依次在它上面执行，不再向池借用 (否则可能等待排在后面的请求所持有的上下文而死锁)
+    bool use_tiling(const ImageView& image) const;
+    int infer_tiled(const ImageView& image, ArgmaxOutput mode, cv::Mat& mask, ComponentSet* components = nullptr,
+                    InferenceSlot* slot = nullptr);
+    // 推理一行分块并累加到 stitcher。band 是从第 y 行开始的最多 kInputHeight 行像素，
+    // xs 为各分块的起始列；不足一个分块的部分用边缘像素补齐。slot 同上
+    int infer_tile_row(const cv::Mat& band, PixelFormat format, const std::vector<int>& xs, int64_t y,
+                       ArgmaxOutput mode, TileStitcher& stitcher, InferenceSlot* slot = nullptr);
+    // 在一个执行上下文上以 N = count 执行一次引擎调用；letterbox 选定的输入尺寸不同时按尺寸分组，每组一次。
+    // slot 为空时从池中借用一个上下文，否则使用调用方持有的 slot
+    int infer_batch(BatchJob* const* jobs, size_t count, InferenceSlot* slot = nullptr);
+
+    // infer_batch 的三个阶段，流水线模式下分别在不同线程上执行：
+    // prepare: 设置形状、绑定缓冲区并预处理; execute: 推理 (TensorRT 包括 H2D/D2H); finish: 后处理
+    int prepare(InferenceSlot& slot, BatchJob* const* jobs, size_t count);
+    int execute(InferenceSlot& slot);
+    int finish(const InferenceSlot& slot, BatchJob* const* jobs, size_t count);
+
+    // 未设置输入桶或 fixed_input 时为拉伸到 kInputWidth x kInputHeight，否则为 letterbox
+    InputGeometry input_geometry(const BatchJob& job) const;
+    void preprocess(InferenceSlot& slot, const ImageView& image, float* dst, const InputGeometry& geometry);
+    // 按输出的实际类型分派：fp32/fp16 分数做 argmax，int32/int64/uint8 类别索引图只做窄化复制或阈值。
+    // 写入 job 的 mask 或 packed
+    void postprocess(const void* output, TensorDataType type, const OutputLayout& layout, BatchJob& job);
+
+    // 模型的输入尺寸
+    static constexpr int kInputHeight = 256;
+    static constexpr int kInputWidth = 2048;
+
+    BackendKind backend_kind_ = BackendKind::kTensorRT;
+    std::unique_ptr<InferenceBackend> backend_;
+
+    // 必须声明在 backend_ 之后，保证上下文先于模型销毁
+    ResourcePool<InferenceSlot> slots_;
+    int num_contexts_ = 1;
+    int max_engine_batch_ = 1;
+
+    bool tiling_ = false;
+    int tile_overlap_ = 64;
+    double polygon_epsilon_ = 1.0;
+    std::vector<ShapeBucket> shape_buckets_;
+
+    // 所有 slot 和流水线线程共同写入
+    InferenceStats stats_;
+    std::string trace_dump_path_;
+
+    // 以下两者必须声明在 slots_ 之后，保证先于执行上下文销毁
+    std::unique_ptr<BatchScheduler<BatchJob>> scheduler_;
+    std::unique_ptr<SegmentationPipeline> pipeline_;
 };
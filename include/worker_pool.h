@@ -0,0 +1,66 @@
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// 简单的定长线程池，用于把阻塞的文件读写从流水线阶段线程上移走。
+// 任务按提交顺序开始执行；析构时先执行完所有已提交的任务再退出。
+class WorkerPool {
+public:
+    using Task = std::function<void()>;
+
+    explicit WorkerPool(size_t num_workers) {
+        num_workers = std::max<size_t>(num_workers, 1);
+        for (size_t i = 0; i < num_workers; ++i) {
+            this->workers_.emplace_back([this] { this->worker_loop(); });
+        }
+    }
+
+    ~WorkerPool() {
+        {
+            std::lock_guard<std::mutex> lock(this->mutex_);
+            this->stopping_ = true;
+        }
+        this->cv_.notify_all();
+        for (auto& worker : this->workers_) worker.join();
+    }
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    void post(Task task) {
+        {
+            std::lock_guard<std::mutex> lock(this->mutex_);
+            this->tasks_.push_back(std::move(task));
+        }
+        this->cv_.notify_one();
+    }
+
+    size_t size() const { return this->workers_.size(); }
+
+private:
+    void worker_loop() {
+        for (;;) {
+            Task task;
+            {
+                std::unique_lock<std::mutex> lock(this->mutex_);
+                this->cv_.wait(lock, [this] { return this->stopping_ || !this->tasks_.empty(); });
+                if (this->tasks_.empty()) return; // stopping and drained
+                task = std::move(this->tasks_.front());
+                this->tasks_.pop_front();
+            }
+            task();
+        }
+    }
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<Task> tasks_;
+    bool stopping_ = false;
+    std::vector<std::thread> workers_;
+};
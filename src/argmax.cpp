@@ -0,0 +1,509 @@
+#include "../include/argmax.h"
+#include "../include/cpu_features.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+#if defined(TRT_SEG_X86)
+    #include <immintrin.h>
+#endif
+
+namespace {
+
+using ArgmaxFn = void (*)(const float*, int, size_t, size_t, uint8_t*, ArgmaxOutput);
+using ArgmaxConfidenceFn = void (*)(const float*, int, size_t, size_t, uint8_t*, ArgmaxOutput, float*);
+
+// exp(x) for x <= 0 as 2^n * p(f): n = round(x * log2(e)), f in [-0.5, 0.5], p the degree-5
+// Taylor polynomial of 2^f (relative error below 1e-5). Inputs under -87 flush to about 1.6e-38.
+// NaN takes the same clamp (like maxps, which returns the second operand), so a NaN logit
+// contributes nothing to the softmax sum and n is always a valid integer.
+constexpr float kLog2e = 1.44269504f;
+constexpr float kExpC1 = 0.693147182f;
+constexpr float kExpC2 = 0.240226507f;
+constexpr float kExpC3 = 0.0555041087f;
+constexpr float kExpC4 = 0.00961812911f;
+constexpr float kExpC5 = 0.00133335581f;
+
+inline float fast_exp(float x) {
+    const float t = (x > -87.0f ? x : -87.0f) * kLog2e;
+    const float n = std::nearbyint(t);
+    const float f = t - n;
+    const float p = 1.0f + f * (kExpC1 + f * (kExpC2 + f * (kExpC3 + f * (kExpC4 + f * kExpC5))));
+    const uint32_t bits = static_cast<uint32_t>(static_cast<int32_t>(n) + 127) << 23;
+    float scale;
+    std::memcpy(&scale, &bits, sizeof(scale));
+    return p * scale;
+}
+
+// 1 / sum clamped to [0, 1]. The winning class contributes exp(0) = 1, so the clamp only matters
+// for non-finite logits: +inf - +inf is NaN, and a NaN winner (class 0 is NaN) gets 0
+inline float confidence_from_sum(float max_val, float sum) {
+    if (std::isnan(max_val)) return 0.0f;
+    return std::min(1.0f / sum, 1.0f);
+}
+
+inline uint8_t encode(int idx, ArgmaxOutput mode) {
+    if (mode == ArgmaxOutput::kForegroundMask) return idx > 0 ? 255 : 0;
+    // Saturates like the packus narrowing in the SIMD kernels
+    return static_cast<uint8_t>(std::min(idx, 255));
+}
+
+void argmax_scalar(const float* logits, int num_classes, size_t plane_stride, size_t count,
+                   uint8_t* out, ArgmaxOutput mode) {
+    for (size_t i = 0; i < count; ++i) {
+        const float* p = logits + i;
+        float max_val = p[0];
+        int max_idx = 0;
+        for (int c = 1; c < num_classes; ++c) {
+            p += plane_stride;
+            if (*p > max_val) {
+                max_val = *p;
+                max_idx = c;
+            }
+        }
+        out[i] = encode(max_idx, mode);
+    }
+}
+
+// softmax 的最大概率 = 1 / Σ exp(l_c - l_max)，在 argmax 之后对同一批像素再遍历一次类别平面
+void argmax_confidence_scalar(const float* logits, int num_classes, size_t plane_stride, size_t count,
+                              uint8_t* out, ArgmaxOutput mode, float* confidence) {
+    for (size_t i = 0; i < count; ++i) {
+        const float* p = logits + i;
+        float max_val = p[0];
+        int max_idx = 0;
+        for (int c = 1; c < num_classes; ++c) {
+            p += plane_stride;
+            if (*p > max_val) {
+                max_val = *p;
+                max_idx = c;
+            }
+        }
+        float sum = 0.0f;
+        p = logits + i;
+        for (int c = 0; c < num_classes; ++c, p += plane_stride) sum += fast_exp(*p - max_val);
+        out[i] = encode(max_idx, mode);
+        confidence[i] = confidence_from_sum(max_val, sum);
+    }
+}
+
+#if defined(TRT_SEG_X86)
+
+// SSE4.1: 每次 4 个像素
+TRT_SEG_TARGET("sse4.1")
+void argmax_sse41(const float* logits, int num_classes, size_t plane_stride, size_t count,
+                  uint8_t* out, ArgmaxOutput mode) {
+    const bool as_mask = mode == ArgmaxOutput::kForegroundMask;
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i fg = _mm_set1_epi32(255);
+
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const float* p = logits + i;
+        __m128 best = _mm_loadu_ps(p);
+        __m128 best_idx = _mm_setzero_ps();
+        for (int c = 1; c < num_classes; ++c) {
+            p += plane_stride;
+            const __m128 v = _mm_loadu_ps(p);
+            const __m128 gt = _mm_cmpgt_ps(v, best);
+            best = _mm_blendv_ps(best, v, gt);
+            best_idx = _mm_blendv_ps(best_idx, _mm_set1_ps(static_cast<float>(c)), gt);
+        }
+        __m128i idx = _mm_cvttps_epi32(best_idx);
+        if (as_mask) idx = _mm_and_si128(_mm_cmpgt_epi32(idx, zero), fg);
+        idx = _mm_packus_epi32(idx, idx);
+        idx = _mm_packus_epi16(idx, idx);
+        const int packed = _mm_cvtsi128_si32(idx);
+        std::memcpy(out + i, &packed, 4);
+    }
+    argmax_scalar(logits + i, num_classes, plane_stride, count - i, out + i, mode);
+}
+
+// AVX2: 每次 16 个像素 (两组 8 路交错以隐藏比较/混合的依赖延迟)
+TRT_SEG_TARGET("avx2")
+void argmax_avx2(const float* logits, int num_classes, size_t plane_stride, size_t count,
+                 uint8_t* out, ArgmaxOutput mode) {
+    const bool as_mask = mode == ArgmaxOutput::kForegroundMask;
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i fg = _mm256_set1_epi32(255);
+
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        const float* p = logits + i;
+        __m256 best0 = _mm256_loadu_ps(p);
+        __m256 best1 = _mm256_loadu_ps(p + 8);
+        __m256 idx0 = _mm256_setzero_ps();
+        __m256 idx1 = _mm256_setzero_ps();
+        for (int c = 1; c < num_classes; ++c) {
+            p += plane_stride;
+            const __m256 cls = _mm256_set1_ps(static_cast<float>(c));
+            const __m256 v0 = _mm256_loadu_ps(p);
+            const __m256 v1 = _mm256_loadu_ps(p + 8);
+            const __m256 gt0 = _mm256_cmp_ps(v0, best0, _CMP_GT_OQ);
+            const __m256 gt1 = _mm256_cmp_ps(v1, best1, _CMP_GT_OQ);
+            best0 = _mm256_blendv_ps(best0, v0, gt0);
+            best1 = _mm256_blendv_ps(best1, v1, gt1);
+            idx0 = _mm256_blendv_ps(idx0, cls, gt0);
+            idx1 = _mm256_blendv_ps(idx1, cls, gt1);
+        }
+        __m256i i0 = _mm256_cvttps_epi32(idx0);
+        __m256i i1 = _mm256_cvttps_epi32(idx1);
+        if (as_mask) {
+            i0 = _mm256_and_si256(_mm256_cmpgt_epi32(i0, zero), fg);
+            i1 = _mm256_and_si256(_mm256_cmpgt_epi32(i1, zero), fg);
+        }
+        const __m128i w0 = _mm_packus_epi32(_mm256_castsi256_si128(i0), _mm256_extracti128_si256(i0, 1));
+        const __m128i w1 = _mm_packus_epi32(_mm256_castsi256_si128(i1), _mm256_extracti128_si256(i1, 1));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_packus_epi16(w0, w1));
+    }
+    argmax_scalar(logits + i, num_classes, plane_stride, count - i, out + i, mode);
+}
+
+// AVX-512F: 每次 16 个像素，尾部使用掩码加载/存储，无需标量收尾
+TRT_SEG_TARGET("avx512f")
+void argmax_avx512(const float* logits, int num_classes, size_t plane_stride, size_t count,
+                   uint8_t* out, ArgmaxOutput mode) {
+    const bool as_mask = mode == ArgmaxOutput::kForegroundMask;
+    const __m512i zero = _mm512_setzero_si512();
+    const __m512i fg = _mm512_set1_epi32(255);
+
+    for (size_t i = 0; i < count; i += 16) {
+        const size_t remaining = count - i;
+        const __mmask16 lanes = remaining >= 16 ? static_cast<__mmask16>(0xFFFF)
+                                                : static_cast<__mmask16>((1u << remaining) - 1);
+        const float* p = logits + i;
+        __m512 best = _mm512_maskz_loadu_ps(lanes, p);
+        __m512i best_idx = zero;
+        for (int c = 1; c < num_classes; ++c) {
+            p += plane_stride;
+            const __m512 v = _mm512_maskz_loadu_ps(lanes, p);
+            const __mmask16 gt = _mm512_cmp_ps_mask(v, best, _CMP_GT_OQ);
+            best = _mm512_mask_mov_ps(best, gt, v);
+            best_idx = _mm512_mask_mov_epi32(best_idx, gt, _mm512_set1_epi32(c));
+        }
+        if (as_mask) best_idx = _mm512_maskz_mov_epi32(_mm512_cmpgt_epi32_mask(best_idx, zero), fg);
+        _mm512_mask_cvtusepi32_storeu_epi8(out + i, lanes, best_idx);
+    }
+}
+
+// F16C: 每次 8 个
+TRT_SEG_TARGET("f16c,avx")
+void half_to_float_f16c(const uint16_t* src, float* dst, size_t count) {
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m128i h = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        _mm256_storeu_ps(dst + i, _mm256_cvtph_ps(h));
+    }
+    for (; i < count; ++i) dst[i] = _cvtsh_ss(src[i]);
+}
+
+TRT_SEG_TARGET("avx2")
+inline __m256 fast_exp_avx2(__m256 x) {
+    const __m256 t = _mm256_mul_ps(_mm256_max_ps(x, _mm256_set1_ps(-87.0f)), _mm256_set1_ps(kLog2e));
+    const __m256 n = _mm256_round_ps(t, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+    const __m256 f = _mm256_sub_ps(t, n);
+    __m256 p = _mm256_set1_ps(kExpC5);
+    p = _mm256_add_ps(_mm256_mul_ps(p, f), _mm256_set1_ps(kExpC4));
+    p = _mm256_add_ps(_mm256_mul_ps(p, f), _mm256_set1_ps(kExpC3));
+    p = _mm256_add_ps(_mm256_mul_ps(p, f), _mm256_set1_ps(kExpC2));
+    p = _mm256_add_ps(_mm256_mul_ps(p, f), _mm256_set1_ps(kExpC1));
+    p = _mm256_add_ps(_mm256_mul_ps(p, f), _mm256_set1_ps(1.0f));
+    const __m256i bits = _mm256_slli_epi32(_mm256_add_epi32(_mm256_cvtps_epi32(n), _mm256_set1_epi32(127)), 23);
+    return _mm256_mul_ps(p, _mm256_castsi256_ps(bits));
+}
+
+// AVX2: 每次 8 个像素；argmax 与上面相同，随后第二次遍历类别平面累加 exp (数据仍在 L1 中)
+TRT_SEG_TARGET("avx2")
+void argmax_confidence_avx2(const float* logits, int num_classes, size_t plane_stride, size_t count,
+                            uint8_t* out, ArgmaxOutput mode, float* confidence) {
+    const bool as_mask = mode == ArgmaxOutput::kForegroundMask;
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i fg = _mm256_set1_epi32(255);
+
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const float* p = logits + i;
+        __m256 best = _mm256_loadu_ps(p);
+        __m256 best_idx = _mm256_setzero_ps();
+        for (int c = 1; c < num_classes; ++c) {
+            p += plane_stride;
+            const __m256 v = _mm256_loadu_ps(p);
+            const __m256 gt = _mm256_cmp_ps(v, best, _CMP_GT_OQ);
+            best = _mm256_blendv_ps(best, v, gt);
+            best_idx = _mm256_blendv_ps(best_idx, _mm256_set1_ps(static_cast<float>(c)), gt);
+        }
+        __m256 sum = _mm256_setzero_ps();
+        p = logits + i;
+        for (int c = 0; c < num_classes; ++c, p += plane_stride) {
+            sum = _mm256_add_ps(sum, fast_exp_avx2(_mm256_sub_ps(_mm256_loadu_ps(p), best)));
+        }
+        // Same clamp as confidence_from_sum: min(1 / sum, 1), and 0 where the winning score is NaN
+        const __m256 conf = _mm256_min_ps(_mm256_div_ps(_mm256_set1_ps(1.0f), sum), _mm256_set1_ps(1.0f));
+        _mm256_storeu_ps(confidence + i, _mm256_and_ps(conf, _mm256_cmp_ps(best, best, _CMP_ORD_Q)));
+
+        __m256i idx = _mm256_cvttps_epi32(best_idx);
+        if (as_mask) idx = _mm256_and_si256(_mm256_cmpgt_epi32(idx, zero), fg);
+        const __m128i w = _mm_packus_epi32(_mm256_castsi256_si128(idx), _mm256_extracti128_si256(idx, 1));
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(out + i), _mm_packus_epi16(w, w));
+    }
+    argmax_confidence_scalar(logits + i, num_classes, plane_stride, count - i, out + i, mode, confidence + i);
+}
+
+// Only the active lanes are computed (the rest are zero), which also keeps the zero-masked forms
+// that do not need an undefined pass-through register
+TRT_SEG_TARGET("avx512f")
+inline __m512 fast_exp_avx512(__mmask16 lanes, __m512 x) {
+    const __m512 t = _mm512_mul_ps(_mm512_maskz_max_ps(lanes, x, _mm512_set1_ps(-87.0f)), _mm512_set1_ps(kLog2e));
+    const __m512 n = _mm512_maskz_roundscale_ps(lanes, t, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+    const __m512 f = _mm512_sub_ps(t, n);
+    __m512 p = _mm512_set1_ps(kExpC5);
+    p = _mm512_add_ps(_mm512_mul_ps(p, f), _mm512_set1_ps(kExpC4));
+    p = _mm512_add_ps(_mm512_mul_ps(p, f), _mm512_set1_ps(kExpC3));
+    p = _mm512_add_ps(_mm512_mul_ps(p, f), _mm512_set1_ps(kExpC2));
+    p = _mm512_add_ps(_mm512_mul_ps(p, f), _mm512_set1_ps(kExpC1));
+    p = _mm512_add_ps(_mm512_mul_ps(p, f), _mm512_set1_ps(1.0f));
+    const __m512i e = _mm512_add_epi32(_mm512_maskz_cvtps_epi32(lanes, n), _mm512_set1_epi32(127));
+    const __m512i bits = _mm512_maskz_slli_epi32(lanes, e, 23);
+    return _mm512_mul_ps(p, _mm512_castsi512_ps(bits));
+}
+
+// AVX-512F: 每次 16 个像素，尾部使用掩码加载/存储；argmax 与 argmax_avx512 相同，随后累加 exp
+TRT_SEG_TARGET("avx512f")
+void argmax_confidence_avx512(const float* logits, int num_classes, size_t plane_stride, size_t count,
+                              uint8_t* out, ArgmaxOutput mode, float* confidence) {
+    const bool as_mask = mode == ArgmaxOutput::kForegroundMask;
+    const __m512i zero = _mm512_setzero_si512();
+    const __m512i fg = _mm512_set1_epi32(255);
+    const __m512 one = _mm512_set1_ps(1.0f);
+
+    for (size_t i = 0; i < count; i += 16) {
+        const size_t remaining = count - i;
+        const __mmask16 lanes = remaining >= 16 ? static_cast<__mmask16>(0xFFFF)
+                                                : static_cast<__mmask16>((1u << remaining) - 1);
+        const float* p = logits + i;
+        __m512 best = _mm512_maskz_loadu_ps(lanes, p);
+        __m512i best_idx = zero;
+        for (int c = 1; c < num_classes; ++c) {
+            p += plane_stride;
+            const __m512 v = _mm512_maskz_loadu_ps(lanes, p);
+            const __mmask16 gt = _mm512_cmp_ps_mask(v, best, _CMP_GT_OQ);
+            best = _mm512_mask_mov_ps(best, gt, v);
+            best_idx = _mm512_mask_mov_epi32(best_idx, gt, _mm512_set1_epi32(c));
+        }
+        __m512 sum = _mm512_setzero_ps();
+        p = logits + i;
+        for (int c = 0; c < num_classes; ++c, p += plane_stride) {
+            sum = _mm512_add_ps(sum, fast_exp_avx512(lanes, _mm512_sub_ps(_mm512_maskz_loadu_ps(lanes, p), best)));
+        }
+        // Same clamp as confidence_from_sum; lanes with a NaN winning score are zeroed by the mask
+        const __mmask16 ordered = _mm512_mask_cmp_ps_mask(lanes, best, best, _CMP_ORD_Q);
+        const __m512 conf = _mm512_maskz_min_ps(ordered, _mm512_maskz_div_ps(ordered, one, sum), one);
+        _mm512_mask_storeu_ps(confidence + i, lanes, conf);
+
+        if (as_mask) best_idx = _mm512_maskz_mov_epi32(_mm512_cmpgt_epi32_mask(best_idx, zero), fg);
+        _mm512_mask_cvtusepi32_storeu_epi8(out + i, lanes, best_idx);
+    }
+}
+
+// F16C: 每次 8 个，就近舍入
+TRT_SEG_TARGET("f16c,avx")
+void float_to_half_f16c(const float* src, uint16_t* dst, size_t count) {
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        const __m128i h = _mm256_cvtps_ph(_mm256_loadu_ps(src + i), _MM_FROUND_TO_NEAREST_INT);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), h);
+    }
+    for (; i < count; ++i) dst[i] = _cvtss_sh(src[i], _MM_FROUND_TO_NEAREST_INT);
+}
+
+#endif // TRT_SEG_X86
+
+uint16_t float_to_half_one(float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    const uint16_t sign = static_cast<uint16_t>((bits >> 16) & 0x8000);
+    const uint32_t abs = bits & 0x7fffffff;
+    if (abs > 0x7f800000) {
+        // NaN: quieted, keeping the top of the payload like vcvtps2ph
+        return sign | 0x7e00 | static_cast<uint16_t>((abs & 0x7fffff) >> 13);
+    }
+    if (abs == 0x7f800000) {
+        return sign | 0x7c00; // inf
+    }
+    if (abs >= 0x477ff000) {
+        return sign | 0x7c00; // rounds past the largest half
+    }
+    if (abs < 0x38800000) {
+        // Subnormal half (or zero): shift the implicit-one mantissa into place, round to nearest even
+        if (abs < 0x33000000) return sign;
+        const uint32_t exponent = abs >> 23;
+        const uint32_t mantissa = (abs & 0x7fffff) | 0x800000;
+        const uint32_t shift = 126 - exponent;
+        uint32_t half = mantissa >> shift;
+        const uint32_t rest = mantissa & ((1u << shift) - 1);
+        const uint32_t halfway = 1u << (shift - 1);
+        if (rest > halfway || (rest == halfway && (half & 1))) ++half;
+        return sign | static_cast<uint16_t>(half);
+    }
+    // Normal: rebias the exponent and round the mantissa to 10 bits (a carry bumps the exponent)
+    uint32_t half = ((abs >> 13) - (112u << 10));
+    const uint32_t rest = abs & 0x1fff;
+    if (rest > 0x1000 || (rest == 0x1000 && (half & 1))) ++half;
+    return sign | static_cast<uint16_t>(half);
+}
+
+void float_to_half_scalar(const float* src, uint16_t* dst, size_t count) {
+    for (size_t i = 0; i < count; ++i) dst[i] = float_to_half_one(src[i]);
+}
+
+float half_to_float_one(uint16_t h) {
+    const uint32_t sign = static_cast<uint32_t>(h & 0x8000) << 16;
+    uint32_t exponent = (h >> 10) & 0x1f;
+    uint32_t mantissa = h & 0x3ff;
+    uint32_t bits;
+    if (exponent == 0x1f) {
+        // inf, or NaN quieted with its payload kept like vcvtph2ps
+        bits = sign | 0x7f800000 | (mantissa ? 0x400000 | (mantissa << 13) : 0);
+    } else if (exponent != 0) {
+        bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+    } else if (mantissa == 0) {
+        bits = sign;
+    } else {
+        // Subnormal: normalize the mantissa
+        exponent = 113;
+        while (!(mantissa & 0x400)) {
+            mantissa <<= 1;
+            --exponent;
+        }
+        bits = sign | (exponent << 23) | ((mantissa & 0x3ff) << 13);
+    }
+    float f;
+    std::memcpy(&f, &bits, sizeof(f));
+    return f;
+}
+
+void half_to_float_scalar(const uint16_t* src, float* dst, size_t count) {
+    for (size_t i = 0; i < count; ++i) dst[i] = half_to_float_one(src[i]);
+}
+
+using HalfToFloatFn = void (*)(const uint16_t*, float*, size_t);
+using FloatToHalfFn = void (*)(const float*, uint16_t*, size_t);
+
+HalfToFloatFn select_half_to_float() {
+#if defined(TRT_SEG_X86)
+    const CpuFeatures& cpu = cpu_features();
+    if (cpu.f16c && cpu.avx2) return half_to_float_f16c;
+#endif
+    return half_to_float_scalar;
+}
+
+FloatToHalfFn select_float_to_half() {
+#if defined(TRT_SEG_X86)
+    const CpuFeatures& cpu = cpu_features();
+    if (cpu.f16c && cpu.avx2) return float_to_half_f16c;
+#endif
+    return float_to_half_scalar;
+}
+
+ArgmaxConfidenceFn select_confidence_impl() {
+#if defined(TRT_SEG_X86)
+    const CpuFeatures& cpu = cpu_features();
+    if (cpu.avx512f) return argmax_confidence_avx512;
+    if (cpu.avx2) return argmax_confidence_avx2;
+#endif
+    return argmax_confidence_scalar;
+}
+
+ArgmaxConfidenceFn confidence_impl() {
+    static const ArgmaxConfidenceFn selected = select_confidence_impl();
+    return selected;
+}
+
+struct ArgmaxImpl {
+    ArgmaxFn fn;
+    const char* name;
+};
+
+ArgmaxImpl select_impl() {
+#if defined(TRT_SEG_X86)
+    const CpuFeatures& cpu = cpu_features();
+    if (cpu.avx512f) return {argmax_avx512, "avx512"};
+    if (cpu.avx2) return {argmax_avx2, "avx2"};
+    if (cpu.sse41) return {argmax_sse41, "sse4.1"};
+#endif
+    return {argmax_scalar, "scalar"};
+}
+
+const ArgmaxImpl& impl() {
+    static const ArgmaxImpl selected = select_impl();
+    return selected;
+}
+
+} // namespace
+
+void argmax_planar(const float* logits, int num_classes, size_t plane_stride, size_t count,
+                   uint8_t* out, ArgmaxOutput mode) {
+    if (count == 0 || num_classes <= 0) return;
+    impl().fn(logits, num_classes, plane_stride, count, out, mode);
+}
+
+void half_to_float(const uint16_t* src, float* dst, size_t count) {
+    static const HalfToFloatFn fn = select_half_to_float();
+    fn(src, dst, count);
+}
+
+void argmax_planar_f16(const uint16_t* logits, int num_classes, size_t plane_stride, size_t count,
+                       uint8_t* out, ArgmaxOutput mode) {
+    if (count == 0 || num_classes <= 0) return;
+    // A chunk of every class plane stays in L1 while it is converted and reduced
+    constexpr size_t kChunk = 512;
+    thread_local std::vector<float> scratch;
+    scratch.resize(static_cast<size_t>(num_classes) * kChunk);
+    for (size_t begin = 0; begin < count; begin += kChunk) {
+        const size_t n = std::min(kChunk, count - begin);
+        for (int c = 0; c < num_classes; ++c) {
+            half_to_float(logits + c * plane_stride + begin, scratch.data() + c * kChunk, n);
+        }
+        impl().fn(scratch.data(), num_classes, kChunk, n, out + begin, mode);
+    }
+}
+
+void float_to_half(const float* src, uint16_t* dst, size_t count) {
+    static const FloatToHalfFn fn = select_float_to_half();
+    fn(src, dst, count);
+}
+
+void quantize_unit_u8(const float* src, uint8_t* dst, size_t count) {
+    for (size_t i = 0; i < count; ++i) {
+        // Written so that NaN maps to 0 instead of reaching the float -> int conversion
+        const float v = src[i] > 0.0f ? std::min(src[i], 1.0f) : 0.0f;
+        dst[i] = static_cast<uint8_t>(v * 255.0f + 0.5f);
+    }
+}
+
+void argmax_confidence_planar(const float* logits, int num_classes, size_t plane_stride, size_t count,
+                              uint8_t* out, ArgmaxOutput mode, float* confidence) {
+    if (count == 0 || num_classes <= 0) return;
+    confidence_impl()(logits, num_classes, plane_stride, count, out, mode, confidence);
+}
+
+void argmax_confidence_planar_f16(const uint16_t* logits, int num_classes, size_t plane_stride, size_t count,
+                                  uint8_t* out, ArgmaxOutput mode, float* confidence) {
+    if (count == 0 || num_classes <= 0) return;
+    constexpr size_t kChunk = 512;
+    thread_local std::vector<float> scratch;
+    scratch.resize(static_cast<size_t>(num_classes) * kChunk);
+    for (size_t begin = 0; begin < count; begin += kChunk) {
+        const size_t n = std::min(kChunk, count - begin);
+        for (int c = 0; c < num_classes; ++c) {
+            half_to_float(logits + c * plane_stride + begin, scratch.data() + c * kChunk, n);
+        }
+        confidence_impl()(scratch.data(), num_classes, kChunk, n, out + begin, mode, confidence + begin);
+    }
+}
+
+const char* argmax_isa_name() {
+    return impl().name;
+}
@@ -0,0 +1,97 @@
+#include "../include/buffer_pool.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+#ifdef _WIN32
+    #include <malloc.h>
+#endif
+
+namespace {
+
+constexpr size_t kHostAlignment = 64;
+
+void update_max(std::atomic<size_t>& target, size_t value) {
+    size_t current = target.load(std::memory_order_relaxed);
+    while (value > current && !target.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+    }
+}
+
+} // namespace
+
+void* HostAllocator::allocate(size_t bytes) {
+#ifdef _WIN32
+    return _aligned_malloc(bytes, kHostAlignment);
+#else
+    void* ptr = nullptr;
+    if (posix_memalign(&ptr, kHostAlignment, bytes) != 0) return nullptr;
+    return ptr;
+#endif
+}
+
+void HostAllocator::deallocate(void* ptr) {
+#ifdef _WIN32
+    _aligned_free(ptr);
+#else
+    free(ptr);
+#endif
+}
+
+void accumulate(BufferPoolStats& total, const BufferPoolStats& s) {
+    total.allocations += s.allocations;
+    total.reuses += s.reuses;
+    total.reserved_bytes += s.reserved_bytes;
+    total.peak_reserved_bytes += s.peak_reserved_bytes;
+    total.peak_request_bytes = std::max(total.peak_request_bytes, s.peak_request_bytes);
+}
+
+BufferPool::~BufferPool() {
+    this->release_all();
+}
+
+void* BufferPool::acquire(const std::string& tensor, const TensorShape& shape, TensorDataType dtype) {
+    const size_t bytes = shape_volume(shape) * data_type_size(dtype);
+    update_max(this->peak_request_bytes_, bytes);
+
+    Entry& entry = this->entries_[tensor];
+
+    if (entry.ptr && bytes <= entry.capacity) {
+        this->reuses_.fetch_add(1, std::memory_order_relaxed);
+        return entry.ptr;
+    }
+
+    // Grow: the old contents are not needed, so free first to keep the peak low
+    if (entry.ptr) {
+        this->allocator_.deallocate(entry.ptr);
+        this->reserved_bytes_.fetch_sub(entry.capacity, std::memory_order_relaxed);
+        entry.ptr = nullptr;
+        entry.capacity = 0;
+    }
+
+    // Some allocators return nullptr for zero-sized requests
+    entry.ptr = this->allocator_.allocate(bytes > 0 ? bytes : 1);
+    if (!entry.ptr) return nullptr;
+    entry.capacity = bytes;
+    this->allocations_.fetch_add(1, std::memory_order_relaxed);
+    const size_t reserved = this->reserved_bytes_.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+    update_max(this->peak_reserved_bytes_, reserved);
+    return entry.ptr;
+}
+
+void BufferPool::release_all() {
+    for (auto& kv : this->entries_) {
+        if (kv.second.ptr) this->allocator_.deallocate(kv.second.ptr);
+    }
+    this->entries_.clear();
+    this->reserved_bytes_.store(0, std::memory_order_relaxed);
+}
+
+BufferPoolStats BufferPool::stats() const {
+    BufferPoolStats s;
+    s.allocations = this->allocations_.load(std::memory_order_relaxed);
+    s.reuses = this->reuses_.load(std::memory_order_relaxed);
+    s.reserved_bytes = this->reserved_bytes_.load(std::memory_order_relaxed);
+    s.peak_reserved_bytes = this->peak_reserved_bytes_.load(std::memory_order_relaxed);
+    s.peak_request_bytes = this->peak_request_bytes_.load(std::memory_order_relaxed);
+    return s;
+}
@@ -0,0 +1,195 @@
+#include "../include/connected_components.h"
+
+#include <algorithm>
+#include <climits>
+
+ColumnGrid ColumnGrid::identity(int width) {
+    ColumnGrid grid;
+    grid.src.resize(width);
+    grid.x0.resize(static_cast<size_t>(width) + 1);
+    for (int x = 0; x <= width; ++x) {
+        if (x < width) grid.src[x] = x;
+        grid.x0[x] = x;
+    }
+    return grid;
+}
+
+ColumnGrid ColumnGrid::from_map(const int* src_x, int dst_width) {
+    // Destination columns sampling the same source column form one cell; unsampled sources have none
+    ColumnGrid grid;
+    for (int x = 0; x < dst_width; ++x) {
+        if (x == 0 || src_x[x] != src_x[x - 1]) {
+            grid.src.push_back(src_x[x]);
+            grid.x0.push_back(x);
+        }
+    }
+    grid.x0.push_back(dst_width);
+    return grid;
+}
+
+int ComponentLabeller::Chunk::find(int label) {
+    while (this->parent_[label] != label) {
+        this->parent_[label] = this->parent_[this->parent_[label]];
+        label = this->parent_[label];
+    }
+    return label;
+}
+
+void ComponentLabeller::Chunk::unite(int a, int b) {
+    a = this->find(a);
+    b = this->find(b);
+    // The smaller label stays the root, so roots follow scan order
+    if (a < b) this->parent_[b] = a;
+    else if (b < a) this->parent_[a] = b;
+}
+
+void ComponentLabeller::Chunk::add_row(const uint8_t* line, int dy0, int dy1) {
+    const std::vector<int>& src = this->grid_.src;
+    const int cells = static_cast<int>(src.size());
+    this->cur_.clear();
+    for (int g = 0; g < cells;) {
+        const uint8_t value = line[src[g]];
+        int end = g + 1;
+        while (end < cells && line[src[end]] == value) ++end;
+        if (value != 0) this->cur_.push_back({g, end, value, -1});
+        g = end;
+    }
+
+    size_t j = 0;
+    for (Run& run : this->cur_) {
+        // Runs of the previous row touching this one, diagonals included (8-connectivity)
+        while (j < this->prev_.size() && this->prev_[j].g1 < run.g0) ++j;
+        for (size_t k = j; k < this->prev_.size() && this->prev_[k].g0 <= run.g1; ++k) {
+            if (this->prev_[k].value != run.value) continue;
+            if (run.label < 0) run.label = this->find(this->prev_[k].label);
+            else this->unite(run.label, this->prev_[k].label);
+        }
+        if (run.label < 0) {
+            run.label = static_cast<int>(this->parent_.size());
+            this->parent_.push_back(run.label);
+            Accum fresh;
+            fresh.value = run.value;
+            fresh.x_min = fresh.y_min = INT_MAX;
+            fresh.x_max = fresh.y_max = INT_MIN;
+            this->accum_.push_back(fresh);
+        }
+
+        // The run covers destination columns [x0, x1) on rows [dy0, dy1)
+        const int x0 = this->grid_.x0[run.g0];
+        const int x1 = this->grid_.x0[run.g1];
+        const int64_t w = x1 - x0;
+        const int64_t h = dy1 - dy0;
+        Accum& a = this->accum_[run.label];
+        a.area += w * h;
+        a.x_min = std::min(a.x_min, x0);
+        a.x_max = std::max(a.x_max, x1 - 1);
+        a.y_min = std::min(a.y_min, dy0);
+        a.y_max = std::max(a.y_max, dy1 - 1);
+        a.sum_x += static_cast<double>(h) * static_cast<double>(x0 + x1 - 1) * static_cast<double>(w) / 2.0;
+        a.sum_y += static_cast<double>(w) * static_cast<double>(dy0 + dy1 - 1) * static_cast<double>(h) / 2.0;
+    }
+
+    if (!this->has_rows_) {
+        this->first_ = this->cur_;
+        this->has_rows_ = true;
+    }
+    std::swap(this->prev_, this->cur_);
+}
+
+ComponentLabeller::Chunk* ComponentLabeller::begin_chunk(int first_row) {
+    std::lock_guard<std::mutex> lock(this->mutex_);
+    this->chunks_.emplace_back(new Chunk(this->grid_, first_row));
+    return this->chunks_.back().get();
+}
+
+void ComponentLabeller::finish(int64_t min_area, std::vector<ComponentStats>& out) {
+    out.clear();
+    std::sort(this->chunks_.begin(), this->chunks_.end(),
+              [](const std::unique_ptr<Chunk>& a, const std::unique_ptr<Chunk>& b) { return a->first_row_ < b->first_row_; });
+
+    // Global label = chunk offset + local label, starting from the chunk-local forests
+    std::vector<int> offsets(this->chunks_.size());
+    int total = 0;
+    for (size_t c = 0; c < this->chunks_.size(); ++c) {
+        offsets[c] = total;
+        total += static_cast<int>(this->chunks_[c]->parent_.size());
+    }
+    std::vector<int> parent(total);
+    for (size_t c = 0; c < this->chunks_.size(); ++c) {
+        Chunk& chunk = *this->chunks_[c];
+        for (size_t l = 0; l < chunk.parent_.size(); ++l) {
+            parent[offsets[c] + l] = offsets[c] + chunk.find(static_cast<int>(l));
+        }
+    }
+    auto find = [&parent](int label) {
+        while (parent[label] != label) {
+            parent[label] = parent[parent[label]];
+            label = parent[label];
+        }
+        return label;
+    };
+
+    // Stitch the last row of each chunk to the first row of the next chunk that has rows
+    const Chunk* above = nullptr;
+    int above_offset = 0;
+    for (size_t c = 0; c < this->chunks_.size(); ++c) {
+        const Chunk& below = *this->chunks_[c];
+        if (!below.has_rows_) continue;
+        if (above) {
+            size_t j = 0;
+            for (const Chunk::Run& run : below.first_) {
+                while (j < above->prev_.size() && above->prev_[j].g1 < run.g0) ++j;
+                for (size_t k = j; k < above->prev_.size() && above->prev_[k].g0 <= run.g1; ++k) {
+                    if (above->prev_[k].value != run.value) continue;
+                    const int a = find(above_offset + above->prev_[k].label);
+                    const int b = find(offsets[c] + run.label);
+                    if (a < b) parent[b] = a;
+                    else if (b < a) parent[a] = b;
+                }
+            }
+        }
+        above = &below;
+        above_offset = offsets[c];
+    }
+
+    // Fold every label's partial statistics into its root
+    std::vector<int> slot(total, -1);
+    std::vector<Chunk::Accum> merged;
+    for (size_t c = 0; c < this->chunks_.size(); ++c) {
+        const Chunk& chunk = *this->chunks_[c];
+        for (size_t l = 0; l < chunk.accum_.size(); ++l) {
+            const int root = find(offsets[c] + static_cast<int>(l));
+            const Chunk::Accum& a = chunk.accum_[l];
+            if (slot[root] < 0) {
+                slot[root] = static_cast<int>(merged.size());
+                merged.push_back(a);
+                continue;
+            }
+            Chunk::Accum& m = merged[slot[root]];
+            m.area += a.area;
+            m.x_min = std::min(m.x_min, a.x_min);
+            m.x_max = std::max(m.x_max, a.x_max);
+            m.y_min = std::min(m.y_min, a.y_min);
+            m.y_max = std::max(m.y_max, a.y_max);
+            m.sum_x += a.sum_x;
+            m.sum_y += a.sum_y;
+        }
+    }
+
+    for (const Chunk::Accum& m : merged) {
+        if (m.area < min_area || m.area == 0) continue;
+        ComponentStats stats;
+        stats.class_id = m.value;
+        stats.area = m.area;
+        stats.x = m.x_min;
+        stats.y = m.y_min;
+        stats.width = m.x_max - m.x_min + 1;
+        stats.height = m.y_max - m.y_min + 1;
+        stats.centroid_x = m.sum_x / static_cast<double>(m.area);
+        stats.centroid_y = m.sum_y / static_cast<double>(m.area);
+        out.push_back(stats);
+    }
+    std::sort(out.begin(), out.end(), [](const ComponentStats& a, const ComponentStats& b) {
+        return a.y != b.y ? a.y < b.y : a.x < b.x;
+    });
+}
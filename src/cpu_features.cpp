@@ -0,0 +1,85 @@
+#include "../include/cpu_features.h"
+
+#if defined(TRT_SEG_X86)
+    #if defined(_MSC_VER)
+        #include <intrin.h>
+    #else
+        #include <cpuid.h>
+    #endif
+#endif
+
+namespace {
+
+#if defined(TRT_SEG_X86)
+
+void cpuid(unsigned int leaf, unsigned int subleaf, unsigned int regs[4]) {
+#if defined(_MSC_VER)
+    int r[4];
+    __cpuidex(r, static_cast<int>(leaf), static_cast<int>(subleaf));
+    for (int i = 0; i < 4; ++i) regs[i] = static_cast<unsigned int>(r[i]);
+#else
+    __cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+#endif
+}
+
+unsigned long long xgetbv0() {
+#if defined(_MSC_VER)
+    return _xgetbv(0);
+#else
+    unsigned int eax, edx;
+    __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+    return (static_cast<unsigned long long>(edx) << 32) | eax;
+#endif
+}
+
+CpuFeatures detect() {
+    CpuFeatures f;
+    unsigned int regs[4] = {0, 0, 0, 0};
+
+    cpuid(0, 0, regs);
+    const unsigned int max_leaf = regs[0];
+    if (max_leaf < 1) return f;
+
+    cpuid(1, 0, regs);
+    const unsigned int ecx1 = regs[2];
+    f.sse41 = (ecx1 >> 19) & 1;
+
+    // AVX 系列还需要操作系统保存 YMM/ZMM 状态 (OSXSAVE + XCR0)
+    const bool osxsave = (ecx1 >> 27) & 1;
+    const bool avx = (ecx1 >> 28) & 1;
+    if (!osxsave || !avx) return f;
+
+    const unsigned long long xcr0 = xgetbv0();
+    const bool ymm_state = (xcr0 & 0x6) == 0x6;
+    const bool zmm_state = (xcr0 & 0xE6) == 0xE6;
+    if (!ymm_state) return f;
+
+    f.fma = (ecx1 >> 12) & 1;
+    f.f16c = (ecx1 >> 29) & 1;
+
+    if (max_leaf >= 7) {
+        cpuid(7, 0, regs);
+        const unsigned int ebx7 = regs[1];
+        f.avx2 = (ebx7 >> 5) & 1;
+        if (zmm_state) {
+            f.avx512f = (ebx7 >> 16) & 1;
+            f.avx512bw = (ebx7 >> 30) & 1;
+        }
+    }
+    return f;
+}
+
+#else
+
+CpuFeatures detect() {
+    return CpuFeatures();
+}
+
+#endif
+
+} // namespace
+
+const CpuFeatures& cpu_features() {
+    static const CpuFeatures features = detect();
+    return features;
+}
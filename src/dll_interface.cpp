@@ -1,6 +1,49 @@
 #include "trt_segmentation.h"
 #include "../include/trt_segmentation_impl.h"
 
+#include <cstring>
+
+namespace {
+
+// 校验 C 接口传入的缓冲区参数并构造 ImageView
+bool make_image_view(const uint8_t* pixels, int width, int height, int stride, int pixel_format,
+                     const uint8_t* out, int out_stride, ImageView& view) {
+    if (!pixels || !out || width <= 0 || height <= 0) return false;
+    if (pixel_format < TRT_SEG_PIXEL_BGR8 || pixel_format > TRT_SEG_PIXEL_GRAY8) return false;
+
+    const PixelFormat format = static_cast<PixelFormat>(pixel_format);
+    if (stride < width * pixel_format_channels(format) || out_stride < width) return false;
+
+    view.data = pixels;
+    view.width = width;
+    view.height = height;
+    view.stride = static_cast<size_t>(stride);
+    view.format = format;
+    return true;
+}
+
+bool valid_component_output(const TRT_SEG_COMPONENT* components, int capacity, const int* count) {
+    return count && capacity >= 0 && (components || capacity == 0);
+}
+
+void copy_components(const ComponentSet& set, TRT_SEG_COMPONENT* components, int capacity, int* count) {
+    const size_t n = std::min(set.items.size(), static_cast<size_t>(capacity));
+    for (size_t i = 0; i < n; ++i) {
+        const ComponentStats& c = set.items[i];
+        components[i].class_id = c.class_id;
+        components[i].area = c.area;
+        components[i].x = c.x;
+        components[i].y = c.y;
+        components[i].width = c.width;
+        components[i].height = c.height;
+        components[i].centroid_x = c.centroid_x;
+        components[i].centroid_y = c.centroid_y;
+    }
+    *count = static_cast<int>(set.items.size());
+}
+
+} // namespace
+
 extern "C" {
 
 TRT_SEG_API TRT_SEG_HANDLE create_segmentation_instance() {
@@ -15,16 +58,354 @@ TRT_SEG_API void destroy_segmentation_instance(TRT_SEG_HANDLE handle) {
     }
 }
 
+TRT_SEG_API int set_backend(TRT_SEG_HANDLE handle, int backend) {
+    if (!handle || backend < TRT_SEG_BACKEND_TENSORRT || backend > TRT_SEG_BACKEND_NULL) return -1;
+    TRTSegmentation* instance = reinterpret_cast<TRTSegmentation*>(handle);
+    return instance->set_backend(static_cast<BackendKind>(backend));
+}
+
 TRT_SEG_API int init_engine(TRT_SEG_HANDLE handle, const char* engine_path) {
     if (!handle || !engine_path) return -1;
     TRTSegmentation* instance = reinterpret_cast<TRTSegmentation*>(handle);
     return instance->init(engine_path);
 }
 
+TRT_SEG_API int init_engine_from_memory(TRT_SEG_HANDLE handle, const void* engine_data, size_t engine_size) {
+    if (!handle || !engine_data || engine_size == 0) return -1;
+    TRTSegmentation* instance = reinterpret_cast<TRTSegmentation*>(handle);
+    return instance->init_from_memory(engine_data, engine_size);
+}
+
+TRT_SEG_API int set_context_pool_size(TRT_SEG_HANDLE handle, int num_contexts) {
+    if (!handle) return -1;
+    TRTSegmentation* instance = reinterpret_cast<TRTSegmentation*>(handle);
+    return instance->set_num_contexts(num_contexts);
+}
+
+TRT_SEG_API int set_dynamic_batching(TRT_SEG_HANDLE handle, int max_batch_size, int max_delay_us) {
+    if (!handle) return -1;
+    TRTSegmentation* instance = reinterpret_cast<TRTSegmentation*>(handle);
+    return instance->set_dynamic_batching(max_batch_size, max_delay_us);
+}
+
+TRT_SEG_API int set_tiling(TRT_SEG_HANDLE handle, int enable, int overlap_pixels) {
+    if (!handle) return -1;
+    return reinterpret_cast<TRTSegmentation*>(handle)->set_tiling(enable != 0, overlap_pixels);
+}
+
+TRT_SEG_API int set_shape_buckets(TRT_SEG_HANDLE handle, const int* sizes, int count) {
+    if (!handle || count < 0 || (count > 0 && !sizes)) return -1;
+    std::vector<ShapeBucket> buckets(static_cast<size_t>(count));
+    for (int i = 0; i < count; ++i) {
+        buckets[i].width = sizes[2 * i];
+        buckets[i].height = sizes[2 * i + 1];
+    }
+    return reinterpret_cast<TRTSegmentation*>(handle)->set_shape_buckets(buckets);
+}
+
+TRT_SEG_API TRT_SEG_STREAM stream_open(TRT_SEG_HANDLE handle, int width, int pixel_format, int overlap_rows) {
+    if (!handle || pixel_format < TRT_SEG_PIXEL_BGR8 || pixel_format > TRT_SEG_PIXEL_GRAY8) return nullptr;
+    TRTSegmentation* instance = reinterpret_cast<TRTSegmentation*>(handle);
+    std::unique_ptr<StreamSession> stream =
+        instance->open_stream(width, static_cast<PixelFormat>(pixel_format), overlap_rows, ArgmaxOutput::kForegroundMask);
+    return reinterpret_cast<TRT_SEG_STREAM>(stream.release());
+}
+
+TRT_SEG_API int stream_push_rows(TRT_SEG_STREAM stream, const uint8_t* pixels, int num_rows, int stride) {
+    if (!stream || num_rows < 0 || (num_rows > 0 && !pixels) || stride < 0) return -1;
+    return reinterpret_cast<StreamSession*>(stream)->push_rows(pixels, num_rows, static_cast<size_t>(stride));
+}
+
+TRT_SEG_API int stream_pop_mask_rows(TRT_SEG_STREAM stream, uint8_t* mask_out, int max_rows, int mask_stride) {
+    if (!stream || !mask_out || max_rows < 0 || mask_stride < 0) return -1;
+    return reinterpret_cast<StreamSession*>(stream)->pop_mask_rows(mask_out, max_rows, static_cast<size_t>(mask_stride));
+}
+
+TRT_SEG_API int stream_finish(TRT_SEG_STREAM stream) {
+    if (!stream) return -1;
+    return reinterpret_cast<StreamSession*>(stream)->finish();
+}
+
+TRT_SEG_API void stream_close(TRT_SEG_STREAM stream) {
+    delete reinterpret_cast<StreamSession*>(stream);
+}
+
 TRT_SEG_API int run_inference(TRT_SEG_HANDLE handle, const char* image_path, const char* output_mask_path) {
     if (!handle || !image_path || !output_mask_path) return -1;
     TRTSegmentation* instance = reinterpret_cast<TRTSegmentation*>(handle);
     return instance->run(image_path, output_mask_path);
 }
 
+TRT_SEG_API int run_inference_ex(TRT_SEG_HANDLE handle, const char* image_path, const char* output_mask_path, int mask_format) {
+    if (!handle || !image_path || !output_mask_path) return -1;
+    if (mask_format < TRT_SEG_MASK_PNG || mask_format > TRT_SEG_MASK_POLYGON_BINARY) return -1;
+    TRTSegmentation* instance = reinterpret_cast<TRTSegmentation*>(handle);
+    return instance->run(image_path, output_mask_path, static_cast<MaskFormat>(mask_format));
+}
+
+TRT_SEG_API int run_inference_encoded(TRT_SEG_HANDLE handle, const void* data, size_t size, const char* output_mask_path) {
+    if (!handle || !data || size == 0 || !output_mask_path) return -1;
+    TRTSegmentation* instance = reinterpret_cast<TRTSegmentation*>(handle);
+    return instance->run_encoded(data, size, output_mask_path, mask_format_for_path(output_mask_path));
+}
+
+TRT_SEG_API int run_inference_buffer(TRT_SEG_HANDLE handle, const uint8_t* pixels, int width, int height, int stride,
+                                     int pixel_format, uint8_t* mask_out, int mask_stride) {
+    ImageView view;
+    if (!handle || !make_image_view(pixels, width, height, stride, pixel_format, mask_out, mask_stride, view)) return -1;
+    TRTSegmentation* instance = reinterpret_cast<TRTSegmentation*>(handle);
+    return instance->run_buffer(view, ArgmaxOutput::kForegroundMask, mask_out, static_cast<size_t>(mask_stride));
+}
+
+TRT_SEG_API int run_inference_buffer_labels(TRT_SEG_HANDLE handle, const uint8_t* pixels, int width, int height, int stride,
+                                            int pixel_format, uint8_t* labels_out, int labels_stride) {
+    ImageView view;
+    if (!handle || !make_image_view(pixels, width, height, stride, pixel_format, labels_out, labels_stride, view)) return -1;
+    TRTSegmentation* instance = reinterpret_cast<TRTSegmentation*>(handle);
+    return instance->run_buffer(view, ArgmaxOutput::kLabels, labels_out, static_cast<size_t>(labels_stride));
+}
+
+TRT_SEG_API int run_inference_buffer_confidence(TRT_SEG_HANDLE handle, const uint8_t* pixels, int width, int height,
+                                                int stride, int pixel_format, uint8_t* labels_out, int labels_stride,
+                                                void* confidence_out, int confidence_stride, int confidence_format) {
+    ImageView view;
+    if (!handle || !confidence_out || !make_image_view(pixels, width, height, stride, pixel_format, labels_out, labels_stride, view)) {
+        return -1;
+    }
+    if (confidence_format != TRT_SEG_CONFIDENCE_U8 && confidence_format != TRT_SEG_CONFIDENCE_F16) return -1;
+    const bool half = confidence_format == TRT_SEG_CONFIDENCE_F16;
+    if (confidence_stride < width * (half ? 2 : 1)) return -1;
+    TRTSegmentation* instance = reinterpret_cast<TRTSegmentation*>(handle);
+    return instance->run_buffer_confidence(view, ArgmaxOutput::kLabels, labels_out, static_cast<size_t>(labels_stride),
+                                           confidence_out, static_cast<size_t>(confidence_stride), half);
+}
+
+TRT_SEG_API int run_inference_buffer_lowres(TRT_SEG_HANDLE handle, const uint8_t* pixels, int width, int height, int stride,
+                                            int pixel_format, uint8_t* mask_out, int mask_capacity, int* mask_width,
+                                            int* mask_height) {
+    ImageView view;
+    // The mask is tightly packed at the model's resolution, so only the input is validated here
+    if (!handle || !mask_width || !mask_height || mask_capacity < 0 ||
+        !make_image_view(pixels, width, height, stride, pixel_format, mask_out, width, view)) {
+        return -1;
+    }
+    TRTSegmentation* instance = reinterpret_cast<TRTSegmentation*>(handle);
+    return instance->run_buffer_lowres(view, ArgmaxOutput::kForegroundMask, mask_out, static_cast<size_t>(mask_capacity),
+                                       *mask_width, *mask_height);
+}
+
+TRT_SEG_API int run_inference_components(TRT_SEG_HANDLE handle, const char* image_path, const char* output_mask_path,
+                                         int min_area, TRT_SEG_COMPONENT* components, int capacity, int* count) {
+    if (!handle || !image_path || !output_mask_path || !valid_component_output(components, capacity, count)) return -1;
+    TRTSegmentation* instance = reinterpret_cast<TRTSegmentation*>(handle);
+    ComponentSet set;
+    set.min_area = min_area;
+    if (instance->run(image_path, output_mask_path, mask_format_for_path(output_mask_path), &set) != 0) return -1;
+    copy_components(set, components, capacity, count);
+    return 0;
+}
+
+TRT_SEG_API int run_inference_buffer_components(TRT_SEG_HANDLE handle, const uint8_t* pixels, int width, int height,
+                                                int stride, int pixel_format, int per_class, uint8_t* mask_out,
+                                                int mask_stride, int min_area, TRT_SEG_COMPONENT* components,
+                                                int capacity, int* count) {
+    ImageView view;
+    if (!handle || !valid_component_output(components, capacity, count) ||
+        !make_image_view(pixels, width, height, stride, pixel_format, mask_out, mask_stride, view)) {
+        return -1;
+    }
+    TRTSegmentation* instance = reinterpret_cast<TRTSegmentation*>(handle);
+    ComponentSet set;
+    set.min_area = min_area;
+    const ArgmaxOutput mode = per_class ? ArgmaxOutput::kLabels : ArgmaxOutput::kForegroundMask;
+    if (instance->run_buffer(view, mode, mask_out, static_cast<size_t>(mask_stride), &set) != 0) return -1;
+    copy_components(set, components, capacity, count);
+    return 0;
+}
+
+TRT_SEG_API int set_polygon_epsilon(TRT_SEG_HANDLE handle, double epsilon) {
+    if (!handle) return -1;
+    TRTSegmentation* instance = reinterpret_cast<TRTSegmentation*>(handle);
+    return instance->set_polygon_epsilon(epsilon);
+}
+
+TRT_SEG_API int run_inference_buffer_polygons(TRT_SEG_HANDLE handle, const uint8_t* pixels, int width, int height,
+                                              int stride, int pixel_format, int per_class, double epsilon,
+                                              TRT_SEG_POLYGON* polygons, int polygon_capacity, float* points,
+                                              int point_capacity, int* polygon_count, int* point_count) {
+    ImageView view;
+    // No raster output at all; a dummy stride satisfies the validation
+    if (!handle || !polygon_count || !point_count || polygon_capacity < 0 || point_capacity < 0 ||
+        (!polygons && polygon_capacity > 0) || (!points && point_capacity > 0) || !(epsilon >= 0.0) ||
+        !make_image_view(pixels, width, height, stride, pixel_format, pixels, width, view)) {
+        return -1;
+    }
+    TRTSegmentation* instance = reinterpret_cast<TRTSegmentation*>(handle);
+    std::vector<PolygonRing> rings;
+    const ArgmaxOutput mode = per_class ? ArgmaxOutput::kLabels : ArgmaxOutput::kForegroundMask;
+    if (instance->run_buffer_polygons(view, mode, epsilon, rings) != 0) return -1;
+
+    size_t total_points = 0;
+    for (const PolygonRing& ring : rings) total_points += ring.xy.size() / 2;
+    *polygon_count = static_cast<int>(rings.size());
+    *point_count = static_cast<int>(total_points);
+    if (rings.size() > static_cast<size_t>(polygon_capacity) || total_points > static_cast<size_t>(point_capacity)) {
+        return -1;
+    }
+
+    size_t next = 0;
+    for (size_t i = 0; i < rings.size(); ++i) {
+        const size_t n = rings[i].xy.size() / 2;
+        polygons[i].class_id = rings[i].class_id;
+        polygons[i].parent = rings[i].parent;
+        polygons[i].first_point = static_cast<int>(next);
+        polygons[i].num_points = static_cast<int>(n);
+        std::memcpy(points + 2 * next, rings[i].xy.data(), n * 2 * sizeof(float));
+        next += n;
+    }
+    return 0;
+}
+
+TRT_SEG_API int run_inference_buffer_packed(TRT_SEG_HANDLE handle, const uint8_t* pixels, int width, int height, int stride,
+                                            int pixel_format, uint8_t* bits_out, int bits_stride) {
+    ImageView view;
+    // A row of bits is narrower than the image, so the output stride is checked by run_buffer_packed
+    if (!handle || bits_stride < 0 || !make_image_view(pixels, width, height, stride, pixel_format, bits_out, width, view)) {
+        return -1;
+    }
+    TRTSegmentation* instance = reinterpret_cast<TRTSegmentation*>(handle);
+    return instance->run_buffer_packed(view, bits_out, static_cast<size_t>(bits_stride));
+}
+
+TRT_SEG_API int pipeline_start(TRT_SEG_HANDLE handle, int queue_depth) {
+    if (!handle) return -1;
+    TRTSegmentation* instance = reinterpret_cast<TRTSegmentation*>(handle);
+    return instance->start_pipeline(queue_depth);
+}
+
+TRT_SEG_API int pipeline_submit(TRT_SEG_HANDLE handle, const char* image_path, const char* output_mask_path) {
+    if (!handle || !image_path || !output_mask_path) return -1;
+    TRTSegmentation* instance = reinterpret_cast<TRTSegmentation*>(handle);
+    return instance->pipeline_submit(image_path, output_mask_path);
+}
+
+TRT_SEG_API int pipeline_flush(TRT_SEG_HANDLE handle) {
+    if (!handle) return -1;
+    TRTSegmentation* instance = reinterpret_cast<TRTSegmentation*>(handle);
+    return instance->pipeline_flush();
+}
+
+TRT_SEG_API void pipeline_stop(TRT_SEG_HANDLE handle) {
+    if (handle) {
+        reinterpret_cast<TRTSegmentation*>(handle)->stop_pipeline();
+    }
+}
+
+TRT_SEG_API int run_inference_batch(TRT_SEG_HANDLE handle, const char** image_paths, const char** output_mask_paths,
+                                    int count, int* statuses) {
+    if (!handle) return -1;
+    TRTSegmentation* instance = reinterpret_cast<TRTSegmentation*>(handle);
+    return instance->run_batch(image_paths, output_mask_paths, count, statuses);
+}
+
+TRT_SEG_API int run_inference_manifest(TRT_SEG_HANDLE handle, const char* manifest_path) {
+    if (!handle || !manifest_path) return -1;
+    TRTSegmentation* instance = reinterpret_cast<TRTSegmentation*>(handle);
+    return instance->run_manifest(manifest_path);
+}
+
+TRT_SEG_API int get_pipeline_stats(TRT_SEG_HANDLE handle, TRT_SEG_PIPELINE_STATS* stats) {
+    if (!handle || !stats) return -1;
+    TRTSegmentation* instance = reinterpret_cast<TRTSegmentation*>(handle);
+    PipelineStageStats stages[kNumPipelineStages];
+    PipelineStageStats io;
+    if (instance->pipeline_stats(stages, io) != 0) return -1;
+    auto copy = [](const PipelineStageStats& from, TRT_SEG_PIPELINE_STAGE_STATS& to) {
+        to.queue_depth = static_cast<int>(from.queue_depth);
+        to.queue_capacity = static_cast<int>(from.queue_capacity);
+        to.items = from.items;
+        to.busy_ratio = from.busy_ratio;
+    };
+    for (int i = 0; i < kNumPipelineStages; ++i) copy(stages[i], stats->stages[i]);
+    copy(io, stats->io);
+    return 0;
+}
+
+TRT_SEG_API int get_buffer_pool_stats(TRT_SEG_HANDLE handle, TRT_SEG_BUFFER_STATS* stats) {
+    if (!handle || !stats) return -1;
+    TRTSegmentation* instance = reinterpret_cast<TRTSegmentation*>(handle);
+    BufferPoolStats device, host;
+    instance->buffer_stats(device, host);
+    stats->device_allocations = device.allocations;
+    stats->device_reuses = device.reuses;
+    stats->device_reserved_bytes = device.reserved_bytes;
+    stats->device_peak_reserved_bytes = device.peak_reserved_bytes;
+    stats->host_allocations = host.allocations;
+    stats->host_reuses = host.reuses;
+    stats->host_reserved_bytes = host.reserved_bytes;
+    stats->host_peak_reserved_bytes = host.peak_reserved_bytes;
+    return 0;
+}
+
+TRT_SEG_API int get_inference_stats(TRT_SEG_HANDLE handle, TRT_SEG_INFERENCE_STATS* stats) {
+    if (!handle || !stats) return -1;
+    TRTSegmentation* instance = reinterpret_cast<TRTSegmentation*>(handle);
+    LatencySummary summaries[kNumInferenceStages];
+    instance->inference_stats(summaries);
+    for (int i = 0; i < kNumInferenceStages; ++i) {
+        TRT_SEG_STAGE_STATS& out = stats->stages[i];
+        out.count = summaries[i].count;
+        out.mean_us = summaries[i].mean_us;
+        out.p50_us = summaries[i].p50_us;
+        out.p90_us = summaries[i].p90_us;
+        out.p99_us = summaries[i].p99_us;
+        out.p999_us = summaries[i].p999_us;
+        out.max_us = summaries[i].max_us;
+    }
+    return 0;
+}
+
+TRT_SEG_API void reset_inference_stats(TRT_SEG_HANDLE handle) {
+    if (handle) {
+        reinterpret_cast<TRTSegmentation*>(handle)->reset_inference_stats();
+    }
+}
+
+TRT_SEG_API int enable_perf_counters(TRT_SEG_HANDLE handle, int enable) {
+    if (!handle) return -1;
+    return reinterpret_cast<TRTSegmentation*>(handle)->enable_perf_counters(enable != 0);
+}
+
+TRT_SEG_API int get_perf_counters(TRT_SEG_HANDLE handle, TRT_SEG_PERF_COUNTERS* counters) {
+    if (!handle || !counters) return -1;
+    PerfSummary summaries[kNumInferenceStages];
+    reinterpret_cast<TRTSegmentation*>(handle)->perf_counters(summaries);
+    for (int i = 0; i < kNumInferenceStages; ++i) {
+        TRT_SEG_STAGE_PERF& out = counters->stages[i];
+        out.count = summaries[i].count;
+        out.cycles = summaries[i].totals[kPerfCycles];
+        out.instructions = summaries[i].totals[kPerfInstructions];
+        out.llc_misses = summaries[i].totals[kPerfLLCMisses];
+        out.branch_misses = summaries[i].totals[kPerfBranchMisses];
+    }
+    return 0;
+}
+
+TRT_SEG_API int enable_tracing(TRT_SEG_HANDLE handle, int events_per_thread, const char* dump_on_destroy_path) {
+    if (!handle || events_per_thread <= 0) return -1;
+    return reinterpret_cast<TRTSegmentation*>(handle)->start_trace(static_cast<size_t>(events_per_thread),
+                                                                  dump_on_destroy_path ? dump_on_destroy_path : "");
+}
+
+TRT_SEG_API void disable_tracing(TRT_SEG_HANDLE handle) {
+    if (handle) {
+        reinterpret_cast<TRTSegmentation*>(handle)->stop_trace();
+    }
+}
+
+TRT_SEG_API int dump_trace(TRT_SEG_HANDLE handle, const char* path) {
+    if (!handle || !path) return -1;
+    return reinterpret_cast<TRTSegmentation*>(handle)->dump_trace(path);
+}
+
 }
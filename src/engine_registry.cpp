@@ -0,0 +1,110 @@
+#include "../include/engine_registry.h"
+#include "../include/mapped_file.h"
+
+#include <filesystem>
+#include <iostream>
+
+namespace {
+
+// 规范化路径 + 已打开文件的标识；路径无法解析时返回空字符串
+std::string file_key(const std::string& path, const MappedFile& file) {
+    std::error_code ec;
+    const std::filesystem::path canonical = std::filesystem::canonical(path, ec);
+    if (ec) return std::string();
+    return canonical.string() + '|' + file.identity();
+}
+
+} // namespace
+
+SharedEngine::~SharedEngine() {
+    // The engine must be destroyed before the runtime that created it
+    this->engine.reset();
+    this->runtime.reset();
+}
+
+std::shared_ptr<SharedEngine> load_engine(const void* engine_data, size_t engine_size) {
+    auto shared = std::make_shared<SharedEngine>();
+
+    shared->runtime.reset(nvinfer1::createInferRuntime(shared->logger));
+    if (!shared->runtime) {
+        std::cerr << "Error: Failed to create TensorRT runtime." << std::endl;
+        return nullptr;
+    }
+
+    shared->engine.reset(shared->runtime->deserializeCudaEngine(engine_data, engine_size));
+    if (!shared->engine) {
+        std::cerr << "Error: Failed to deserialize CUDA engine." << std::endl;
+        return nullptr;
+    }
+    return shared;
+}
+
+EngineRegistry& EngineRegistry::instance() {
+    static EngineRegistry registry;
+    return registry;
+}
+
+std::shared_ptr<SharedEngine> EngineRegistry::acquire(const std::string& engine_path) {
+    // Deserialize straight from the page cache instead of copying the file into a vector first.
+    // TensorRT keeps its own copy of the weights, so the mapping is released on return.
+    // The key is taken from the opened file, so a file replaced in between cannot be cached
+    // under the identity of a different version.
+    MappedFile engine_file;
+    if (!engine_file.open(engine_path)) return nullptr;
+    const std::string key = file_key(engine_path, engine_file);
+    if (key.empty()) {
+        std::cerr << "Error: Could not open engine file: " << engine_path << std::endl;
+        return nullptr;
+    }
+
+    for (;;) {
+        std::shared_ptr<Entry> entry;
+        std::promise<void> loaded;
+        bool owner = false;
+        {
+            std::lock_guard<std::mutex> lock(this->mutex_);
+            auto it = this->entries_.find(key);
+            if (it != this->entries_.end()) {
+                if (!it->second->done) {
+                    entry = it->second;
+                } else if (auto shared = it->second->engine.lock()) {
+                    return shared;
+                }
+            }
+            if (!entry) {
+                // Drop entries whose engines have already been released
+                for (auto e = this->entries_.begin(); e != this->entries_.end();) {
+                    e = e->second->done && e->second->engine.expired() ? this->entries_.erase(e) : std::next(e);
+                }
+                entry = std::make_shared<Entry>();
+                entry->loaded = loaded.get_future().share();
+                this->entries_[key] = entry;
+                owner = true;
+            }
+        }
+
+        if (!owner) {
+            // Another handle is deserializing this model; share its result instead of loading a second copy
+            entry->loaded.wait();
+            std::lock_guard<std::mutex> lock(this->mutex_);
+            if (entry->failed) return nullptr;
+            if (auto shared = entry->engine.lock()) return shared;
+            continue; // released again before we got to it
+        }
+
+        // Deserialize outside the lock so that loading one model does not stall handles on other models
+        std::shared_ptr<SharedEngine> shared = load_engine(engine_file.data(), engine_file.size());
+        {
+            std::lock_guard<std::mutex> lock(this->mutex_);
+            entry->done = true;
+            entry->failed = !shared;
+            entry->engine = shared;
+            if (!shared) {
+                auto it = this->entries_.find(key);
+                if (it != this->entries_.end() && it->second == entry) this->entries_.erase(it);
+            }
+        }
+        loaded.set_value();
+        return shared;
+    }
+}
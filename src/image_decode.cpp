@@ -0,0 +1,84 @@
+#include "../include/image_decode.h"
+
+#include <utility>
+
+namespace {
+
+inline int read_u16(const uint8_t* p) {
+    return (p[0] << 8) | p[1]; // JPEG segments are big-endian
+}
+
+inline int64_t ceil_div(int64_t value, int64_t denominator) {
+    return (value + denominator - 1) / denominator;
+}
+
+} // namespace
+
+bool jpeg_dimensions(const uint8_t* data, size_t size, int& width, int& height) {
+    if (size < 4 || data[0] != 0xFF || data[1] != 0xD8) {
+        return false;
+    }
+    size_t pos = 2;
+    while (pos + 4 <= size) {
+        if (data[pos] != 0xFF) return false;
+        const uint8_t marker = data[pos + 1];
+        if (marker == 0xFF) { // fill byte before the marker
+            ++pos;
+            continue;
+        }
+        // Standalone markers carry no length
+        if (marker == 0x01 || (marker >= 0xD0 && marker <= 0xD7)) {
+            pos += 2;
+            continue;
+        }
+        if (marker == 0xD9 || marker == 0xDA) return false; // no frame header before the scan data
+
+        const size_t length = static_cast<size_t>(read_u16(data + pos + 2));
+        if (length < 2) return false;
+        // SOF0..SOF15, except DHT (C4), JPG (C8) and DAC (CC) which share the range
+        if (marker >= 0xC0 && marker <= 0xCF && marker != 0xC4 && marker != 0xC8 && marker != 0xCC) {
+            if (pos + 9 > size || length < 7) return false;
+            height = read_u16(data + pos + 5);
+            width = read_u16(data + pos + 7);
+            return width > 0 && height > 0;
+        }
+        pos += 2 + length;
+    }
+    return false;
+}
+
+int reduced_decode_denominator(int width, int height, int min_width, int min_height) {
+    for (int denominator = 8; denominator > 1; denominator /= 2) {
+        if (ceil_div(width, denominator) >= min_width && ceil_div(height, denominator) >= min_height) {
+            return denominator;
+        }
+    }
+    return 1;
+}
+
+void decode_image(const uint8_t* data, size_t size, int denominator, DecodedImage& out) {
+    int flags = cv::IMREAD_COLOR;
+    switch (denominator) {
+        case 2: flags = cv::IMREAD_REDUCED_COLOR_2; break;
+        case 4: flags = cv::IMREAD_REDUCED_COLOR_4; break;
+        case 8: flags = cv::IMREAD_REDUCED_COLOR_8; break;
+        default: denominator = 1; break;
+    }
+
+    // Wraps the encoded bytes without copying them
+    const cv::Mat encoded(1, static_cast<int>(size), CV_8UC1, const_cast<uint8_t*>(data));
+    out.pixels = cv::imdecode(encoded, flags);
+    out.width = out.pixels.cols;
+    out.height = out.pixels.rows;
+
+    int width = 0, height = 0;
+    if (out.pixels.empty() || denominator == 1 || !jpeg_dimensions(data, size, width, height)) {
+        return;
+    }
+    // EXIF orientation may have transposed the decoded image relative to the frame header
+    if (ceil_div(width, denominator) != out.pixels.cols) {
+        std::swap(width, height);
+    }
+    out.width = width;
+    out.height = height;
+}
@@ -0,0 +1,37 @@
+#include "../include/inference_backend.h"
+
+#include <iostream>
+
+std::unique_ptr<InferenceBackend> create_backend(BackendKind kind, const std::string& model_path) {
+    switch (kind) {
+        case BackendKind::kTensorRT:
+#ifdef TRT_SEG_WITH_TENSORRT
+            return create_tensorrt_backend(model_path);
+#else
+            break;
+#endif
+        case BackendKind::kOpenCV:
+            return create_opencv_backend(model_path);
+        case BackendKind::kNull:
+            return create_null_backend(model_path);
+    }
+    std::cerr << "Error: Backend is not available in this build." << std::endl;
+    return nullptr;
+}
+
+std::unique_ptr<InferenceBackend> create_backend(BackendKind kind, const void* model_data, size_t model_size) {
+    switch (kind) {
+        case BackendKind::kTensorRT:
+#ifdef TRT_SEG_WITH_TENSORRT
+            return create_tensorrt_backend(model_data, model_size);
+#else
+            break;
+#endif
+        case BackendKind::kOpenCV:
+            return create_opencv_backend(model_data, model_size);
+        case BackendKind::kNull:
+            return create_null_backend(std::string(static_cast<const char*>(model_data), model_size));
+    }
+    std::cerr << "Error: Backend is not available in this build." << std::endl;
+    return nullptr;
+}
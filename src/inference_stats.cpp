@@ -0,0 +1,75 @@
+#include "../include/inference_stats.h"
+
+#include <algorithm>
+
+const char* inference_stage_name(InferenceStage stage) {
+    static const char* const names[kNumInferenceStages] = {
+        "decode", "preprocess", "h2d", "execute", "d2h", "postprocess", "upscale", "encode", "request",
+    };
+    return stage >= 0 && stage < kNumInferenceStages ? names[stage] : "unknown";
+}
+
+int LatencyHistogram::bucket_index(uint64_t ns) {
+    if (ns < static_cast<uint64_t>(kSubBuckets)) {
+        return static_cast<int>(ns); // exact below 16 ns
+    }
+    int exponent = 63;
+    while (!(ns >> exponent)) --exponent; // position of the highest set bit, >= 4 here
+    if (exponent > kMaxExponent) {
+        return kNumBuckets - 1;
+    }
+    const int sub = static_cast<int>((ns >> (exponent - 4)) & (kSubBuckets - 1));
+    return (exponent - 3) * kSubBuckets + sub;
+}
+
+uint64_t LatencyHistogram::bucket_lower_bound(int index) {
+    if (index < kSubBuckets) {
+        return static_cast<uint64_t>(index);
+    }
+    const int exponent = index / kSubBuckets + 3;
+    const uint64_t sub = static_cast<uint64_t>(index % kSubBuckets);
+    return (kSubBuckets + sub) << (exponent - 4);
+}
+
+void LatencyHistogram::reset() {
+    for (auto& bucket : this->buckets_) bucket.store(0, std::memory_order_relaxed);
+    this->count_.store(0, std::memory_order_relaxed);
+    this->sum_ns_.store(0, std::memory_order_relaxed);
+    this->max_ns_.store(0, std::memory_order_relaxed);
+}
+
+LatencySummary LatencyHistogram::summary() const {
+    // Take a private copy first so the percentiles are computed from one consistent set of counts
+    uint64_t counts[kNumBuckets];
+    uint64_t total = 0;
+    for (int i = 0; i < kNumBuckets; ++i) {
+        counts[i] = this->buckets_[i].load(std::memory_order_relaxed);
+        total += counts[i];
+    }
+
+    LatencySummary summary;
+    summary.count = total;
+    if (total == 0) {
+        return summary;
+    }
+    const double max_ns = static_cast<double>(this->max_ns_.load(std::memory_order_relaxed));
+    summary.max_us = max_ns / 1000.0;
+    summary.mean_us = static_cast<double>(this->sum_ns_.load(std::memory_order_relaxed)) /
+                      static_cast<double>(std::max<uint64_t>(this->count_.load(std::memory_order_relaxed), 1)) / 1000.0;
+
+    const double quantiles[4] = {0.50, 0.90, 0.99, 0.999};
+    double* outputs[4] = {&summary.p50_us, &summary.p90_us, &summary.p99_us, &summary.p999_us};
+    int q = 0;
+    uint64_t seen = 0;
+    for (int i = 0; i < kNumBuckets && q < 4; ++i) {
+        seen += counts[i];
+        while (q < 4 && static_cast<double>(seen) >= quantiles[q] * static_cast<double>(total)) {
+            const double lower = static_cast<double>(bucket_lower_bound(i));
+            const double upper = i + 1 < kNumBuckets ? static_cast<double>(bucket_lower_bound(i + 1)) : lower;
+            // Never report more than the largest sample actually seen
+            *outputs[q] = std::min((lower + upper) / 2.0, max_ns) / 1000.0;
+            ++q;
+        }
+    }
+    return summary;
+}
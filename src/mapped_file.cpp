@@ -0,0 +1,130 @@
+#include "../include/mapped_file.h"
+
+#include <iostream>
+#include <sstream>
+
+#ifdef _WIN32
+    #ifndef NOMINMAX
+        #define NOMINMAX
+    #endif
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+MappedFile::~MappedFile() {
+    this->close();
+}
+
+#ifdef _WIN32
+
+bool MappedFile::open(const std::string& path) {
+    this->close();
+
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        std::cerr << "Error: Could not open file: " << path << std::endl;
+        return false;
+    }
+
+    LARGE_INTEGER file_size;
+    BY_HANDLE_FILE_INFORMATION info;
+    if (!GetFileSizeEx(file, &file_size) || file_size.QuadPart == 0 || !GetFileInformationByHandle(file, &info)) {
+        std::cerr << "Error: Could not get size of file: " << path << std::endl;
+        CloseHandle(file);
+        return false;
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mapping) {
+        std::cerr << "Error: Could not map file: " << path << std::endl;
+        CloseHandle(file);
+        return false;
+    }
+
+    void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!view) {
+        std::cerr << "Error: Could not map view of file: " << path << std::endl;
+        CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+
+    this->file_ = file;
+    this->mapping_ = mapping;
+    this->data_ = view;
+    this->size_ = static_cast<size_t>(file_size.QuadPart);
+
+    std::ostringstream identity;
+    identity << info.dwVolumeSerialNumber << ':' << info.nFileIndexHigh << ':' << info.nFileIndexLow << '|'
+             << this->size_ << '|' << info.ftLastWriteTime.dwHighDateTime << ':' << info.ftLastWriteTime.dwLowDateTime;
+    this->identity_ = identity.str();
+    return true;
+}
+
+void MappedFile::close() {
+    if (this->data_) UnmapViewOfFile(this->data_);
+    if (this->mapping_) CloseHandle(static_cast<HANDLE>(this->mapping_));
+    if (this->file_) CloseHandle(static_cast<HANDLE>(this->file_));
+    this->data_ = nullptr;
+    this->mapping_ = nullptr;
+    this->file_ = nullptr;
+    this->size_ = 0;
+    this->identity_.clear();
+}
+
+#else
+
+bool MappedFile::open(const std::string& path) {
+    this->close();
+
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        std::cerr << "Error: Could not open file: " << path << std::endl;
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        std::cerr << "Error: Could not get size of file: " << path << std::endl;
+        ::close(fd);
+        return false;
+    }
+
+    const size_t size = static_cast<size_t>(st.st_size);
+    void* view = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    // The mapping keeps its own reference to the file
+    ::close(fd);
+    if (view == MAP_FAILED) {
+        std::cerr << "Error: Could not map file: " << path << std::endl;
+        return false;
+    }
+
+    // Deserialization reads the file front to back exactly once
+    madvise(view, size, MADV_SEQUENTIAL);
+    madvise(view, size, MADV_WILLNEED);
+
+    this->data_ = view;
+    this->size_ = size;
+
+    std::ostringstream identity;
+    identity << st.st_dev << ':' << st.st_ino << '|' << st.st_size << '|' << st.st_mtime;
+#if defined(__linux__)
+    identity << '.' << st.st_mtim.tv_nsec;
+#endif
+    this->identity_ = identity.str();
+    return true;
+}
+
+void MappedFile::close() {
+    if (this->data_) munmap(this->data_, this->size_);
+    this->data_ = nullptr;
+    this->size_ = 0;
+    this->identity_.clear();
+}
+
+#endif
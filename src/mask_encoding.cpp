@@ -0,0 +1,217 @@
+#include "../include/mask_encoding.h"
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <fstream>
+#include <iostream>
+
+namespace {
+
+bool ends_with(const std::string& s, const char* suffix) {
+    const size_t n = std::char_traits<char>::length(suffix);
+    if (s.size() < n) return false;
+    for (size_t i = 0; i < n; ++i) {
+        if (std::tolower(static_cast<unsigned char>(s[s.size() - n + i])) != suffix[i]) return false;
+    }
+    return true;
+}
+
+inline bool bit_at(const uint8_t* row, int x) {
+    return (row[x >> 3] >> (7 - (x & 7))) & 1;
+}
+
+void append_number(std::string& out, uint64_t value) {
+    char buffer[24];
+    const auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    out.append(buffer, result.ptr);
+}
+
+bool write_file(const std::string& path, const std::string& header, const void* data, size_t size) {
+    std::ofstream out(path, std::ios::binary);
+    out.write(header.data(), static_cast<std::streamsize>(header.size()));
+    out.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+    return static_cast<bool>(out);
+}
+
+} // namespace
+
+MaskFormat mask_format_for_path(const std::string& path) {
+    if (ends_with(path, ".pbm")) return MaskFormat::kPbm;
+    if (ends_with(path, ".rle")) return MaskFormat::kRowRle;
+    if (ends_with(path, ".geojson")) return MaskFormat::kPolygonJson;
+    if (ends_with(path, ".poly")) return MaskFormat::kPolygonBinary;
+    if (ends_with(path, ".json")) return MaskFormat::kCocoRle;
+    return MaskFormat::kPng;
+}
+
+void PackedMask::create(int w, int h) {
+    this->width = w;
+    this->height = h;
+    this->stride = (static_cast<size_t>(w) + 7) / 8;
+    // Padding bits past the last column stay zero, as PBM expects
+    this->bits.assign(this->stride * h, 0);
+}
+
+void pack_row(const uint8_t* line, const int* src_x, int width, uint8_t* out) {
+    const int full = width / 8;
+    for (int b = 0; b < full; ++b) {
+        const int x = b * 8;
+        uint8_t byte = 0;
+        if (src_x) {
+            for (int k = 0; k < 8; ++k) byte |= static_cast<uint8_t>((line[src_x[x + k]] != 0) << (7 - k));
+        } else {
+            for (int k = 0; k < 8; ++k) byte |= static_cast<uint8_t>((line[x + k] != 0) << (7 - k));
+        }
+        out[b] = byte;
+    }
+    if (full * 8 < width) {
+        uint8_t byte = 0;
+        for (int x = full * 8; x < width; ++x) {
+            byte |= static_cast<uint8_t>((line[src_x ? src_x[x] : x] != 0) << (7 - (x & 7)));
+        }
+        out[full] = byte;
+    }
+}
+
+void pack_mask(const uint8_t* mask, size_t mask_stride, int width, int height, PackedMask& packed) {
+    packed.create(width, height);
+    for (int y = 0; y < height; ++y) {
+        pack_row(mask + static_cast<size_t>(y) * mask_stride, nullptr, width, packed.row(y));
+    }
+}
+
+void row_runs(const uint8_t* packed_row, int width, std::vector<uint32_t>& runs) {
+    runs.clear();
+    uint32_t run = 0;
+    bool foreground = false;
+    const int full = width / 8;
+    for (int b = 0; b < full; ++b) {
+        const uint8_t byte = packed_row[b];
+        // Whole bytes of the current value are the common case in a mask
+        if (byte == (foreground ? 0xFF : 0x00)) {
+            run += 8;
+            continue;
+        }
+        for (int k = 7; k >= 0; --k) {
+            const bool bit = (byte >> k) & 1;
+            if (bit != foreground) {
+                runs.push_back(run);
+                run = 0;
+                foreground = bit;
+            }
+            ++run;
+        }
+    }
+    for (int x = full * 8; x < width; ++x) {
+        const bool bit = bit_at(packed_row, x);
+        if (bit != foreground) {
+            runs.push_back(run);
+            run = 0;
+            foreground = bit;
+        }
+        ++run;
+    }
+    runs.push_back(run);
+}
+
+void coco_runs(const PackedMask& packed, std::vector<uint32_t>& runs) {
+    runs.clear();
+    uint32_t run = 0;
+    bool foreground = false;
+    // Column-major (Fortran) order, one run sequence across the whole image
+    for (int x = 0; x < packed.width; ++x) {
+        const size_t byte = static_cast<size_t>(x >> 3);
+        const int shift = 7 - (x & 7);
+        for (int y = 0; y < packed.height; ++y) {
+            const bool bit = (packed.bits[static_cast<size_t>(y) * packed.stride + byte] >> shift) & 1;
+            if (bit != foreground) {
+                runs.push_back(run);
+                run = 0;
+                foreground = bit;
+            }
+            ++run;
+        }
+    }
+    runs.push_back(run);
+}
+
+std::string coco_counts_string(const std::vector<uint32_t>& runs) {
+    // Same as pycocotools rleToString: from the third count on, store the difference to the count two
+    // places back, then emit 5 bits per character (LEB128-like, sign in bit 4) offset by '0'
+    std::string s;
+    s.reserve(runs.size() * 2);
+    for (size_t i = 0; i < runs.size(); ++i) {
+        int64_t x = runs[i];
+        if (i > 2) x -= static_cast<int64_t>(runs[i - 2]);
+        bool more = true;
+        while (more) {
+            char c = static_cast<char>(x & 0x1f);
+            x >>= 5;
+            more = (c & 0x10) ? x != -1 : x != 0;
+            if (more) c |= 0x20;
+            s.push_back(static_cast<char>(c + 48));
+        }
+    }
+    return s;
+}
+
+int write_packed_mask(const std::string& path, MaskFormat format, const PackedMask& packed) {
+    bool ok = false;
+    switch (format) {
+        case MaskFormat::kPng:
+        case MaskFormat::kPolygonJson:
+        case MaskFormat::kPolygonBinary:
+            break;
+        case MaskFormat::kPbm: {
+            // Rows are already stride bytes with zero padding, exactly the P4 raster
+            std::string header = "P4\n";
+            append_number(header, packed.width);
+            header.push_back(' ');
+            append_number(header, packed.height);
+            header.push_back('\n');
+            ok = write_file(path, header, packed.bits.data(), packed.bits.size());
+            break;
+        }
+        case MaskFormat::kRowRle: {
+            std::string text = "RLE ";
+            append_number(text, packed.width);
+            text.push_back(' ');
+            append_number(text, packed.height);
+            text.push_back('\n');
+            std::vector<uint32_t> runs;
+            for (int y = 0; y < packed.height; ++y) {
+                row_runs(packed.row(y), packed.width, runs);
+                for (size_t i = 0; i < runs.size(); ++i) {
+                    if (i > 0) text.push_back(' ');
+                    append_number(text, runs[i]);
+                }
+                text.push_back('\n');
+            }
+            ok = write_file(path, text, nullptr, 0);
+            break;
+        }
+        case MaskFormat::kCocoRle: {
+            std::vector<uint32_t> runs;
+            coco_runs(packed, runs);
+            std::string json = "{\"size\": [";
+            append_number(json, packed.height);
+            json += ", ";
+            append_number(json, packed.width);
+            json += "], \"counts\": \"";
+            // The alphabet runs from '0' to 'o' and includes the backslash, which JSON must escape
+            for (char c : coco_counts_string(runs)) {
+                if (c == '\\') json.push_back('\\');
+                json.push_back(c);
+            }
+            json += "\"}\n";
+            ok = write_file(path, json, nullptr, 0);
+            break;
+        }
+    }
+    if (!ok) {
+        std::cerr << "Error: Could not save output mask: " << path << std::endl;
+        return -1;
+    }
+    return 0;
+}
@@ -0,0 +1,141 @@
+#include "../include/mask_polygons.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+namespace {
+
+template <typename T>
+void append_raw(std::string& out, T value) {
+    // Every supported target is little-endian, so the in-memory bytes are the file layout
+    char bytes[sizeof(T)];
+    std::memcpy(bytes, &value, sizeof(T));
+    out.append(bytes, sizeof(T));
+}
+
+void append_float(std::string& out, float value) {
+    char buffer[32];
+    const int n = std::snprintf(buffer, sizeof(buffer), "%.1f", value);
+    out.append(buffer, static_cast<size_t>(n));
+}
+
+void append_ring_json(std::string& out, const PolygonRing& ring) {
+    out.push_back('[');
+    const size_t points = ring.xy.size() / 2;
+    for (size_t i = 0; i <= points; ++i) {
+        const size_t p = i % points; // GeoJSON rings repeat the first point at the end
+        if (i > 0) out.push_back(',');
+        out.push_back('[');
+        append_float(out, ring.xy[2 * p]);
+        out.push_back(',');
+        append_float(out, ring.xy[2 * p + 1]);
+        out.push_back(']');
+    }
+    out.push_back(']');
+}
+
+} // namespace
+
+void trace_polygons(const cv::Mat& labels, double epsilon, int width, int height, std::vector<PolygonRing>& rings) {
+    rings.clear();
+    bool present[256] = {};
+    for (int y = 0; y < labels.rows; ++y) {
+        const uint8_t* row = labels.ptr(y);
+        for (int x = 0; x < labels.cols; ++x) present[row[x]] = true;
+    }
+
+    // Model pixel centres map to the centres of the blocks they become in the nearest-neighbour upscale
+    const float scale_x = static_cast<float>(width) / static_cast<float>(labels.cols);
+    const float scale_y = static_cast<float>(height) / static_cast<float>(labels.rows);
+
+    cv::Mat binary(labels.rows, labels.cols, CV_8UC1);
+    std::vector<std::vector<cv::Point>> contours;
+    std::vector<cv::Vec4i> hierarchy;
+    std::vector<cv::Point> simplified;
+    for (int value = 1; value < 256; ++value) {
+        if (!present[value]) continue;
+        for (int y = 0; y < labels.rows; ++y) {
+            const uint8_t* src = labels.ptr(y);
+            uint8_t* dst = binary.ptr(y);
+            for (int x = 0; x < labels.cols; ++x) dst[x] = src[x] == value ? 255 : 0;
+        }
+        // Two-level hierarchy: top-level contours are outer boundaries, their children are holes
+        cv::findContours(binary, contours, hierarchy, cv::RETR_CCOMP, cv::CHAIN_APPROX_SIMPLE);
+
+        std::vector<int> index(contours.size(), -1);
+        for (int pass = 0; pass < 2; ++pass) {
+            for (size_t i = 0; i < contours.size(); ++i) {
+                const int parent = hierarchy[i][3];
+                if ((parent < 0) != (pass == 0)) continue;
+                if (parent >= 0 && index[parent] < 0) continue; // the outer ring was dropped
+
+                if (epsilon > 0.0) {
+                    cv::approxPolyDP(contours[i], simplified, epsilon, true);
+                } else {
+                    simplified = contours[i];
+                }
+                if (simplified.size() < 3) continue;
+
+                PolygonRing ring;
+                ring.class_id = value;
+                ring.parent = parent >= 0 ? index[parent] : -1;
+                ring.xy.reserve(simplified.size() * 2);
+                for (const cv::Point& p : simplified) {
+                    ring.xy.push_back((static_cast<float>(p.x) + 0.5f) * scale_x - 0.5f);
+                    ring.xy.push_back((static_cast<float>(p.y) + 0.5f) * scale_y - 0.5f);
+                }
+                index[i] = static_cast<int>(rings.size());
+                rings.push_back(std::move(ring));
+            }
+        }
+    }
+}
+
+int write_polygons(const std::string& path, bool json, const std::vector<PolygonRing>& rings, int width, int height) {
+    std::string out;
+    if (json) {
+        std::vector<std::vector<size_t>> holes(rings.size());
+        for (size_t i = 0; i < rings.size(); ++i) {
+            if (rings[i].parent >= 0) holes[rings[i].parent].push_back(i);
+        }
+        out = "{\"type\":\"FeatureCollection\",\"size\":[" + std::to_string(height) + "," + std::to_string(width) + "],\"features\":[";
+        bool first = true;
+        for (size_t i = 0; i < rings.size(); ++i) {
+            if (rings[i].parent >= 0) continue;
+            if (!first) out.push_back(',');
+            first = false;
+            out += "{\"type\":\"Feature\",\"properties\":{\"class_id\":" + std::to_string(rings[i].class_id) +
+                   "},\"geometry\":{\"type\":\"Polygon\",\"coordinates\":[";
+            append_ring_json(out, rings[i]);
+            for (size_t h : holes[i]) {
+                out.push_back(',');
+                append_ring_json(out, rings[h]);
+            }
+            out += "]}}";
+        }
+        out += "]}\n";
+    } else {
+        out = "SEGP";
+        append_raw<uint32_t>(out, 1);
+        append_raw<uint32_t>(out, static_cast<uint32_t>(width));
+        append_raw<uint32_t>(out, static_cast<uint32_t>(height));
+        append_raw<uint32_t>(out, static_cast<uint32_t>(rings.size()));
+        for (const PolygonRing& ring : rings) {
+            append_raw<int32_t>(out, ring.class_id);
+            append_raw<int32_t>(out, ring.parent);
+            append_raw<uint32_t>(out, static_cast<uint32_t>(ring.xy.size() / 2));
+            out.append(reinterpret_cast<const char*>(ring.xy.data()), ring.xy.size() * sizeof(float));
+        }
+    }
+
+    std::ofstream file(path, std::ios::binary);
+    file.write(out.data(), static_cast<std::streamsize>(out.size()));
+    if (!file) {
+        std::cerr << "Error: Could not save output polygons: " << path << std::endl;
+        return -1;
+    }
+    return 0;
+}
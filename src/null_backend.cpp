@@ -0,0 +1,177 @@
+#include "../include/inference_backend.h"
+
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+
+namespace {
+
+HostAllocator g_host_allocator;
+
+struct NullConfig {
+    int num_classes = 2;
+    int stride = 1;     // 输出相对输入的下采样倍数
+    int max_batch = 16;
+    // 输出类型：fp32/fp16 为 NCHW 分数，int32/int64 为 NHW 类别索引图 (模拟导出时内置了 argmax 的模型)
+    TensorDataType output_type = TensorDataType::kFloat32;
+};
+
+bool parse_dtype(const std::string& name, TensorDataType& type) {
+    if (name == "fp32") type = TensorDataType::kFloat32;
+    else if (name == "fp16") type = TensorDataType::kFloat16;
+    else if (name == "int32") type = TensorDataType::kInt32;
+    else if (name == "int64") type = TensorDataType::kInt64;
+    else return false;
+    return true;
+}
+
+// "classes=2,stride=1,max_batch=16,dtype=fp32"，缺省的键使用默认值
+bool parse_config(const std::string& spec, NullConfig& config) {
+    std::istringstream in(spec);
+    std::string item;
+    while (std::getline(in, item, ',')) {
+        if (item.empty()) continue;
+        const size_t eq = item.find('=');
+        if (eq == std::string::npos) return false;
+        const std::string key = item.substr(0, eq);
+        if (key == "dtype") {
+            if (!parse_dtype(item.substr(eq + 1), config.output_type)) return false;
+            continue;
+        }
+        const int value = std::atoi(item.c_str() + eq + 1);
+        if (value < 1) return false;
+        if (key == "classes") config.num_classes = value;
+        else if (key == "stride") config.stride = value;
+        else if (key == "max_batch") config.max_batch = value;
+        else return false;
+    }
+    return config.num_classes <= 255;
+}
+
+// 不做任何计算：输出是按形状缓存的确定性 logits，
+// 用于单独测量预处理、调度、后处理和文件读写等主机侧开销。
+class NullContext : public BackendContext {
+public:
+    explicit NullContext(const NullConfig& config)
+        : config_(config), input_buffers_(g_host_allocator), output_buffers_(g_host_allocator) {}
+
+    bool set_input_shape(const TensorShape& shape) override {
+        if (shape.size() != 4) {
+            std::cerr << "Error: Failed to set input shape." << std::endl;
+            return false;
+        }
+        this->input_ = static_cast<float*>(this->input_buffers_.acquire("input", shape, TensorDataType::kFloat32));
+        const int64_t height = (shape[2] + this->config_.stride - 1) / this->config_.stride;
+        const int64_t width = (shape[3] + this->config_.stride - 1) / this->config_.stride;
+        const TensorShape output_shape = this->labels()
+                                             ? TensorShape{shape[0], height, width}
+                                             : TensorShape{shape[0], this->config_.num_classes, height, width};
+        this->output_ = this->output_buffers_.acquire("output", output_shape, this->config_.output_type);
+        if (!this->input_ || !this->output_) {
+            std::cerr << "Error: Failed to allocate host buffers." << std::endl;
+            return false;
+        }
+        if (output_shape != this->output_shape_) {
+            this->output_shape_ = output_shape;
+            this->fill();
+        }
+        return true;
+    }
+
+    float* input() override { return this->input_; }
+    bool execute() override {
+        ScopedStageTimer timer(this->stats_, kStageTimeExecute);
+        return true;
+    }
+
+    TensorShape output_shape() const override { return this->output_shape_; }
+    TensorDataType output_type() const override { return this->config_.output_type; }
+    const void* output() const override { return this->output_; }
+
+    void buffer_stats(BufferPoolStats& device, BufferPoolStats& host) const override {
+        // Both pools live in host memory; there is no device side
+        device = BufferPoolStats();
+        host = this->input_buffers_.stats();
+        accumulate(host, this->output_buffers_.stats());
+    }
+
+private:
+    bool labels() const {
+        return this->config_.output_type == TensorDataType::kInt32 || this->config_.output_type == TensorDataType::kInt64;
+    }
+
+    // 类别在 64x32 的块之间轮换，让 argmax 的结果既确定又不是常数
+    void fill() {
+        switch (this->config_.output_type) {
+            case TensorDataType::kFloat32: this->fill_scores(static_cast<float*>(this->output_), 1.0f, 0.0f); break;
+            case TensorDataType::kFloat16: this->fill_scores(static_cast<uint16_t*>(this->output_), uint16_t(0x3c00), uint16_t(0)); break;
+            case TensorDataType::kInt32: this->fill_labels(static_cast<int32_t*>(this->output_)); break;
+            case TensorDataType::kInt64: this->fill_labels(static_cast<int64_t*>(this->output_)); break;
+            default: break;
+        }
+    }
+
+    template <typename T>
+    void fill_scores(T* out, T one, T zero) {
+        const int64_t batch = this->output_shape_[0];
+        const int64_t classes = this->output_shape_[1];
+        const int64_t height = this->output_shape_[2];
+        const int64_t width = this->output_shape_[3];
+        for (int64_t n = 0; n < batch; ++n) {
+            for (int64_t c = 0; c < classes; ++c) {
+                for (int64_t y = 0; y < height; ++y) {
+                    for (int64_t x = 0; x < width; ++x) {
+                        *out++ = c == (x / 64 + y / 32 + n) % classes ? one : zero;
+                    }
+                }
+            }
+        }
+    }
+
+    template <typename T>
+    void fill_labels(T* out) {
+        const int64_t batch = this->output_shape_[0];
+        const int64_t height = this->output_shape_[1];
+        const int64_t width = this->output_shape_[2];
+        for (int64_t n = 0; n < batch; ++n) {
+            for (int64_t y = 0; y < height; ++y) {
+                for (int64_t x = 0; x < width; ++x) {
+                    *out++ = static_cast<T>((x / 64 + y / 32 + n) % this->config_.num_classes);
+                }
+            }
+        }
+    }
+
+    const NullConfig config_;
+    BufferPool input_buffers_;
+    BufferPool output_buffers_;
+    float* input_ = nullptr;
+    void* output_ = nullptr;
+    TensorShape output_shape_;
+};
+
+class NullBackend : public InferenceBackend {
+public:
+    explicit NullBackend(const NullConfig& config) : config_(config) {}
+
+    const char* name() const override { return "null"; }
+    int max_batch_size() const override { return this->config_.max_batch; }
+
+    std::unique_ptr<BackendContext> create_context() override {
+        return std::make_unique<NullContext>(this->config_);
+    }
+
+private:
+    const NullConfig config_;
+};
+
+} // namespace
+
+std::unique_ptr<InferenceBackend> create_null_backend(const std::string& spec) {
+    NullConfig config;
+    if (!parse_config(spec, config)) {
+        std::cerr << "Error: Invalid null backend spec: " << spec << std::endl;
+        return nullptr;
+    }
+    return std::make_unique<NullBackend>(config);
+}
@@ -0,0 +1,122 @@
+#include "../include/inference_backend.h"
+#include "../include/mapped_file.h"
+
+#include <opencv2/dnn.hpp>
+#include <opencv2/opencv.hpp>
+
+#include <iostream>
+#include <vector>
+
+namespace {
+
+HostAllocator g_host_allocator;
+
+// 每个上下文持有自己的 cv::dnn::Net：Net::forward 不能在多个线程上同时调用。
+// 层内的计算由 OpenCV 自己的线程池并行 (cv::setNumThreads 控制线程数)。
+class OpenCVContext : public BackendContext {
+public:
+    explicit OpenCVContext(cv::dnn::Net net) : net_(std::move(net)), input_buffers_(g_host_allocator) {
+        this->net_.setPreferableBackend(cv::dnn::DNN_BACKEND_OPENCV);
+        this->net_.setPreferableTarget(cv::dnn::DNN_TARGET_CPU);
+    }
+
+    bool set_input_shape(const TensorShape& shape) override {
+        if (shape.size() != 4) {
+            std::cerr << "Error: Failed to set input shape." << std::endl;
+            return false;
+        }
+        this->input_ = static_cast<float*>(this->input_buffers_.acquire("input", shape, TensorDataType::kFloat32));
+        if (!this->input_) {
+            std::cerr << "Error: Failed to allocate host input buffer." << std::endl;
+            return false;
+        }
+        this->input_shape_ = shape;
+        return true;
+    }
+
+    float* input() override { return this->input_; }
+
+    bool execute() override {
+        const int sizes[4] = {static_cast<int>(this->input_shape_[0]), static_cast<int>(this->input_shape_[1]),
+                              static_cast<int>(this->input_shape_[2]), static_cast<int>(this->input_shape_[3])};
+        // Wraps the pooled buffer, the network copies it into its own input blob
+        cv::Mat blob(4, sizes, CV_32F, this->input_);
+        ScopedStageTimer timer(this->stats_, kStageTimeExecute);
+        this->net_.setInput(blob);
+        this->output_ = this->net_.forward();
+        timer.stop();
+        if (this->output_.empty() || this->output_.type() != CV_32F || !this->output_.isContinuous()) {
+            std::cerr << "Error: Failed to execute inference." << std::endl;
+            return false;
+        }
+
+        this->output_shape_.assign(this->output_.dims, 0);
+        for (int i = 0; i < this->output_.dims; ++i) this->output_shape_[i] = this->output_.size[i];
+        return true;
+    }
+
+    TensorShape output_shape() const override { return this->output_shape_; }
+    TensorDataType output_type() const override { return TensorDataType::kFloat32; }
+    const void* output() const override { return this->output_.data; }
+
+    void buffer_stats(BufferPoolStats& device, BufferPoolStats& host) const override {
+        device = BufferPoolStats();
+        host = this->input_buffers_.stats();
+    }
+
+private:
+    cv::dnn::Net net_;
+    BufferPool input_buffers_;
+    TensorShape input_shape_;
+    float* input_ = nullptr;
+    // forward() 的结果由 OpenCV 分配，下一次 execute 之前保持有效
+    cv::Mat output_;
+    TensorShape output_shape_;
+};
+
+// 保存一份 ONNX 模型数据，每个上下文从中解析出自己的网络
+class OpenCVBackend : public InferenceBackend {
+public:
+    explicit OpenCVBackend(std::vector<char> model) : model_(std::move(model)) {}
+
+    const char* name() const override { return "opencv"; }
+    // CPU 上合并批次几乎没有收益，而且许多导出的 ONNX 模型批大小固定为 1
+    int max_batch_size() const override { return 1; }
+
+    std::unique_ptr<BackendContext> create_context() override {
+        cv::dnn::Net net = cv::dnn::readNetFromONNX(this->model_.data(), this->model_.size());
+        if (net.empty()) {
+            std::cerr << "Error: Failed to parse ONNX model." << std::endl;
+            return nullptr;
+        }
+        return std::make_unique<OpenCVContext>(std::move(net));
+    }
+
+private:
+    std::vector<char> model_;
+};
+
+} // namespace
+
+std::unique_ptr<InferenceBackend> create_opencv_backend(const std::string& onnx_path) {
+    MappedFile model_file;
+    if (!model_file.open(onnx_path)) {
+        return nullptr;
+    }
+    return create_opencv_backend(model_file.data(), model_file.size());
+}
+
+std::unique_ptr<InferenceBackend> create_opencv_backend(const void* onnx_data, size_t onnx_size) {
+    if (!onnx_data || onnx_size == 0) {
+        std::cerr << "Error: Empty model data." << std::endl;
+        return nullptr;
+    }
+    const char* bytes = static_cast<const char*>(onnx_data);
+    auto backend = std::make_unique<OpenCVBackend>(std::vector<char>(bytes, bytes + onnx_size));
+
+    // Parse once up front so a bad model fails init instead of the first context
+    if (!backend->create_context()) {
+        return nullptr;
+    }
+    return backend;
+}
@@ -0,0 +1,126 @@
+#include "../include/perf_counters.h"
+
+#include <memory>
+
+#if defined(__linux__)
+    #include <linux/perf_event.h>
+    #include <sys/ioctl.h>
+    #include <sys/syscall.h>
+    #include <unistd.h>
+#endif
+
+PerfSample PerfCounterGroup::delta(const PerfSample& begin, const PerfSample& end) {
+    PerfSample d;
+    d.time_enabled = end.time_enabled - begin.time_enabled;
+    d.time_running = end.time_running - begin.time_running;
+    // Scale up when the kernel only had the group on the PMU for part of the interval
+    const double scale = d.time_running > 0 && d.time_running < d.time_enabled
+                             ? static_cast<double>(d.time_enabled) / static_cast<double>(d.time_running)
+                             : 1.0;
+    for (int i = 0; i < kNumPerfCounters; ++i) {
+        d.values[i] = static_cast<uint64_t>(static_cast<double>(end.values[i] - begin.values[i]) * scale);
+    }
+    return d;
+}
+
+#if defined(__linux__)
+
+namespace {
+
+int perf_event_open(perf_event_attr* attr, int group_fd) {
+    // pid = 0, cpu = -1: the calling thread on whichever CPU it runs
+    return static_cast<int>(syscall(__NR_perf_event_open, attr, 0, -1, group_fd, 0));
+}
+
+void describe(PerfCounter counter, perf_event_attr& attr) {
+    switch (counter) {
+        case kPerfCycles:
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = PERF_COUNT_HW_CPU_CYCLES;
+            break;
+        case kPerfInstructions:
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+            break;
+        case kPerfLLCMisses:
+            attr.type = PERF_TYPE_HW_CACHE;
+            attr.config = PERF_COUNT_HW_CACHE_LL | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                          (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+            break;
+        case kPerfBranchMisses:
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = PERF_COUNT_HW_BRANCH_MISSES;
+            break;
+        default:
+            break;
+    }
+}
+
+} // namespace
+
+bool PerfCounterGroup::open() {
+    for (int i = 0; i < kNumPerfCounters; ++i) {
+        perf_event_attr attr{};
+        attr.size = sizeof(attr);
+        describe(static_cast<PerfCounter>(i), attr);
+        attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.disabled = this->leader_fd_ < 0 ? 1 : 0; // the leader starts the whole group
+
+        const int fd = perf_event_open(&attr, this->leader_fd_);
+        if (fd < 0) {
+            if (i == kPerfCycles) return false; // no PMU access at all
+            continue;
+        }
+        if (this->leader_fd_ < 0) this->leader_fd_ = fd;
+        this->fds_[i] = fd;
+        this->slots_[i] = this->num_open_++;
+    }
+    ioctl(this->leader_fd_, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(this->leader_fd_, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    return true;
+}
+
+PerfCounterGroup::~PerfCounterGroup() {
+    for (int fd : this->fds_) {
+        if (fd >= 0) close(fd);
+    }
+}
+
+bool PerfCounterGroup::read(PerfSample& out) const {
+    // Layout for PERF_FORMAT_GROUP: nr, time_enabled, time_running, value[nr]
+    uint64_t buffer[3 + kNumPerfCounters];
+    const ssize_t bytes = ::read(this->leader_fd_, buffer, sizeof(buffer));
+    if (bytes < static_cast<ssize_t>(3 * sizeof(uint64_t))) return false;
+    out.time_enabled = buffer[1];
+    out.time_running = buffer[2];
+    for (int i = 0; i < kNumPerfCounters; ++i) {
+        out.values[i] = this->slots_[i] >= 0 ? buffer[3 + this->slots_[i]] : 0;
+    }
+    return true;
+}
+
+PerfCounterGroup* PerfCounterGroup::for_current_thread() {
+    // Opened once per thread; a failed attempt is not retried
+    thread_local bool attempted = false;
+    thread_local std::unique_ptr<PerfCounterGroup> group;
+    if (!attempted) {
+        attempted = true;
+        group.reset(new PerfCounterGroup());
+        if (!group->open()) group.reset();
+    }
+    return group.get();
+}
+
+#else
+
+PerfCounterGroup::~PerfCounterGroup() = default;
+
+bool PerfCounterGroup::open() { return false; }
+
+bool PerfCounterGroup::read(PerfSample&) const { return false; }
+
+PerfCounterGroup* PerfCounterGroup::for_current_thread() { return nullptr; }
+
+#endif
@@ -0,0 +1,285 @@
+#include "../include/pipeline.h"
+#include "../include/trt_segmentation_impl.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+uint64_t elapsed_ns(Clock::time_point since) {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - since).count());
+}
+
+} // namespace
+
+struct SegmentationPipeline::Item {
+    std::string image_path;
+    std::string output_mask_path;
+    Completion done;
+    Clock::time_point submitted;
+    uint64_t request_id = 0;
+
+    std::future<DecodedImage> decoded; // 在 I/O 线程上预读并解码 (JPEG 可能以缩小的分辨率解码)
+    DecodedImage image;
+    ImageView view;
+    MaskFormat format = MaskFormat::kPng; // 由输出路径的扩展名决定
+    cv::Mat mask;
+    PackedMask packed; // PBM / RLE 格式时代替 mask
+    bool tiled = false; // 分块推理：不经过 prepare/execute，在编码阶段由 infer_tiled 完成
+    BatchJob job;
+    ResourcePool<InferenceSlot>::Lease slot;
+    int status = 0;
+};
+
+SegmentationPipeline::SegmentationPipeline(TRTSegmentation& owner, size_t queue_depth, size_t io_threads)
+    : owner_(owner),
+      queues_{SpscQueue<Item*>(queue_depth), SpscQueue<Item*>(queue_depth), SpscQueue<Item*>(queue_depth)},
+      started_(Clock::now()),
+      max_pending_writes_(std::max<size_t>(queue_depth, 1)),
+      io_(io_threads) {
+    for (int i = 0; i < kNumPipelineStages; ++i) {
+        this->done_[i].store(false);
+        this->items_[i].store(0);
+        this->busy_ns_[i].store(0);
+    }
+    this->threads_[kStageDecode] = std::thread([this] { this->decode_loop(); });
+    this->threads_[kStageInfer] = std::thread([this] { this->infer_loop(); });
+    this->threads_[kStageEncode] = std::thread([this] { this->encode_loop(); });
+}
+
+SegmentationPipeline::~SegmentationPipeline() {
+    this->stopping_.store(true, std::memory_order_release);
+    for (auto& thread : this->threads_) {
+        if (thread.joinable()) thread.join();
+    }
+}
+
+void SegmentationPipeline::push(SpscQueue<Item*>& queue, Item* item) {
+    Backoff backoff;
+    while (!queue.try_push(item)) backoff.pause();
+}
+
+bool SegmentationPipeline::pop(SpscQueue<Item*>& queue, const std::atomic<bool>& upstream_done, Item*& item) {
+    Backoff backoff;
+    while (!queue.try_pop(item)) {
+        // Re-check after observing the flag: anything pushed before it was set is visible now
+        if (upstream_done.load(std::memory_order_acquire)) return queue.try_pop(item);
+        backoff.pause();
+    }
+    return true;
+}
+
+void SegmentationPipeline::submit(const std::string& image_path, const std::string& output_mask_path, Completion done) {
+    Item* item = new Item();
+    item->image_path = image_path;
+    item->output_mask_path = output_mask_path;
+    item->format = mask_format_for_path(output_mask_path);
+    item->done = std::move(done);
+    item->submitted = Clock::now();
+    item->request_id = this->owner_.stats_.next_request_id();
+    {
+        std::lock_guard<std::mutex> lock(this->completion_mutex_);
+        ++this->submitted_;
+    }
+    std::lock_guard<std::mutex> lock(this->submit_mutex_);
+
+    // Start reading the file as soon as the item is accepted, so the decode stage only
+    // waits when it has caught up with the I/O threads. The number of images decoded
+    // ahead is bounded by the first queue, because this blocks once it is full.
+    const TRTSegmentation* owner = &this->owner_;
+    InferenceStats* stats = &this->owner_.stats_;
+    auto read = std::make_shared<std::packaged_task<DecodedImage()>>([path = item->image_path, owner, stats,
+                                                                      id = item->request_id] {
+        TraceRequestScope request(id);
+        ScopedStageTimer timer(stats, kStageTimeDecode);
+        DecodedImage image;
+        owner->decode_file(path, image);
+        return image;
+    });
+    item->decoded = read->get_future();
+    this->post_io([read] { (*read)(); });
+
+    push(this->queues_[kStageDecode], item);
+}
+
+int SegmentationPipeline::flush() {
+    std::unique_lock<std::mutex> lock(this->completion_mutex_);
+    this->completion_cv_.wait(lock, [this] { return this->completed_ == this->submitted_; });
+    const int failures = this->failures_;
+    this->failures_ = 0;
+    return failures;
+}
+
+void SegmentationPipeline::post_io(std::function<void()> task) {
+    this->io_pending_.fetch_add(1, std::memory_order_relaxed);
+    this->io_.post([this, task = std::move(task)] {
+        const Clock::time_point start = Clock::now();
+        task();
+        this->io_busy_ns_.fetch_add(elapsed_ns(start), std::memory_order_relaxed);
+        this->io_items_.fetch_add(1, std::memory_order_relaxed);
+        this->io_pending_.fetch_sub(1, std::memory_order_relaxed);
+    });
+}
+
+void SegmentationPipeline::stats(PipelineStageStats out[kNumPipelineStages], PipelineStageStats& io) const {
+    const double elapsed = static_cast<double>(elapsed_ns(this->started_));
+    for (int i = 0; i < kNumPipelineStages; ++i) {
+        out[i].queue_depth = this->queues_[i].size();
+        out[i].queue_capacity = this->queues_[i].capacity();
+        out[i].items = this->items_[i].load(std::memory_order_relaxed);
+        out[i].busy_ratio = elapsed > 0 ? this->busy_ns_[i].load(std::memory_order_relaxed) / elapsed : 0.0;
+    }
+    io.queue_depth = this->io_pending_.load(std::memory_order_relaxed);
+    io.queue_capacity = this->io_.size();
+    io.items = this->io_items_.load(std::memory_order_relaxed);
+    io.busy_ratio = elapsed > 0 ? this->io_busy_ns_.load(std::memory_order_relaxed) / (elapsed * this->io_.size()) : 0.0;
+}
+
+void SegmentationPipeline::decode_loop() {
+    Item* item = nullptr;
+    while (pop(this->queues_[kStageDecode], this->stopping_, item)) {
+        TraceRequestScope request(item->request_id);
+        // Reading and decoding ran on an I/O thread and is counted there; waiting for it is not work
+        item->image = item->decoded.get();
+        Clock::time_point start = Clock::now();
+        uint64_t busy_ns = 0;
+
+        if (item->image.pixels.empty()) {
+            std::cerr << "Error: Could not read input image: " << item->image_path << std::endl;
+            item->status = -1;
+        } else {
+            item->view.data = item->image.pixels.data;
+            item->view.width = item->image.pixels.cols;
+            item->view.height = item->image.pixels.rows;
+            item->view.stride = item->image.pixels.step;
+            item->view.format = PixelFormat::kBGR;
+            item->job.image = &item->view;
+            item->job.mode = ArgmaxOutput::kForegroundMask;
+            // Tiled images are stitched at the original resolution (decode_target never reduces them)
+            item->tiled = this->owner_.use_tiling(item->view);
+            // Written at full resolution, as bytes for PNG or straight into bits for PBM/RLE
+            if (is_polygon_format(item->format)) {
+                item->job.mask = &item->mask; // empty: contours are traced at the model's resolution
+                if (item->tiled) item->mask.create(item->image.height, item->image.width, CV_8UC1);
+            } else if (item->format == MaskFormat::kPng) {
+                item->mask.create(item->image.height, item->image.width, CV_8UC1);
+                item->job.mask = &item->mask;
+            } else {
+                item->packed.create(item->image.width, item->image.height);
+                item->job.packed = &item->packed;
+            }
+            item->job.request_id = item->request_id;
+
+            // The slot travels with the item until the encode stage hands it back. Waiting for one
+            // means a later stage is the bottleneck, so it is not counted as decode-stage work.
+            // Tiled items take one too and run all their tile batches on it: acquiring more in the
+            // encode stage could wait on slots held by the items queued behind it, which never arrive
+            busy_ns += elapsed_ns(start);
+            item->slot = this->owner_.slots_.acquire();
+            start = Clock::now();
+            if (!item->tiled) {
+                BatchJob* jobs[1] = {&item->job};
+                item->status = this->owner_.prepare(*item->slot, jobs, 1);
+            }
+        }
+
+        busy_ns += elapsed_ns(start);
+        this->busy_ns_[kStageDecode].fetch_add(busy_ns, std::memory_order_relaxed);
+        this->items_[kStageDecode].fetch_add(1, std::memory_order_relaxed);
+        push(this->queues_[kStageInfer], item);
+    }
+    this->done_[kStageDecode].store(true, std::memory_order_release);
+}
+
+void SegmentationPipeline::infer_loop() {
+    Item* item = nullptr;
+    while (pop(this->queues_[kStageInfer], this->done_[kStageDecode], item)) {
+        const Clock::time_point start = Clock::now();
+        TraceRequestScope request(item->request_id);
+        if (item->status == 0 && !item->tiled) {
+            item->status = this->owner_.execute(*item->slot);
+        }
+        this->busy_ns_[kStageInfer].fetch_add(elapsed_ns(start), std::memory_order_relaxed);
+        this->items_[kStageInfer].fetch_add(1, std::memory_order_relaxed);
+        push(this->queues_[kStageEncode], item);
+    }
+    this->done_[kStageInfer].store(true, std::memory_order_release);
+}
+
+void SegmentationPipeline::encode_loop() {
+    Item* item = nullptr;
+    while (pop(this->queues_[kStageEncode], this->done_[kStageInfer], item)) {
+        const Clock::time_point start = Clock::now();
+        TraceRequestScope request(item->request_id);
+        if (item->status == 0 && item->tiled) {
+            // Every tile batch runs on the item's own slot
+            item->status = item->job.packed
+                               ? this->owner_.infer_packed(item->view, item->packed, nullptr, item->slot.get())
+                               : this->owner_.infer_tiled(item->view, item->job.mode, item->mask, nullptr, item->slot.get());
+        } else if (item->status == 0) {
+            BatchJob* jobs[1] = {&item->job};
+            item->status = this->owner_.finish(*item->slot, jobs, 1);
+        }
+        item->slot.release();
+
+        // finish already wrote the mask at the original resolution; the item keeps it until written
+        item->image.pixels.release();
+        this->busy_ns_[kStageEncode].fetch_add(elapsed_ns(start), std::memory_order_relaxed);
+        this->items_[kStageEncode].fetch_add(1, std::memory_order_relaxed);
+
+        if (item->status == 0) {
+            this->write_async(item);
+        } else {
+            this->complete(item);
+        }
+    }
+    this->done_[kStageEncode].store(true, std::memory_order_release);
+}
+
+void SegmentationPipeline::write_async(Item* item) {
+    // Bound the number of encoded masks waiting for a writer
+    {
+        std::unique_lock<std::mutex> lock(this->write_mutex_);
+        this->write_cv_.wait(lock, [this] { return this->pending_writes_ < this->max_pending_writes_; });
+        ++this->pending_writes_;
+    }
+
+    this->post_io([this, item] {
+        TraceRequestScope request(item->request_id);
+        ScopedStageTimer timer(&this->owner_.stats_, kStageTimeEncode);
+        if (is_polygon_format(item->format)) {
+            std::vector<PolygonRing> rings;
+            trace_polygons(item->mask, this->owner_.polygon_epsilon_, item->image.width, item->image.height, rings);
+            item->status = write_polygons(item->output_mask_path, item->format == MaskFormat::kPolygonJson, rings,
+                                          item->image.width, item->image.height);
+        } else if (item->format != MaskFormat::kPng) {
+            item->status = write_packed_mask(item->output_mask_path, item->format, item->packed);
+        } else if (!cv::imwrite(item->output_mask_path, item->mask)) {
+            std::cerr << "Error: Could not save output mask: " << item->output_mask_path << std::endl;
+            item->status = -1;
+        }
+        timer.stop();
+        {
+            std::lock_guard<std::mutex> lock(this->write_mutex_);
+            --this->pending_writes_;
+        }
+        this->write_cv_.notify_one();
+        this->complete(item);
+    });
+}
+
+void SegmentationPipeline::complete(Item* item) {
+    {
+        TraceRequestScope request(item->request_id);
+        this->owner_.stats_.record_span(kStageTimeTotal, item->submitted, Clock::now());
+    }
+    if (item->done) item->done(item->status);
+    const bool failed = item->status != 0;
+    delete item;
+
+    {
+        std::lock_guard<std::mutex> lock(this->completion_mutex_);
+        ++this->completed_;
+        if (failed) ++this->failures_;
+    }
+    this->completion_cv_.notify_all();
+}
@@ -0,0 +1,207 @@
+#include "../include/preprocess.h"
+#include "../include/inference_stats.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include <opencv2/opencv.hpp>
+
+namespace {
+
+// 每个并行任务处理的输出行数
+constexpr int kRowBlock = 16;
+
+// 对一行源像素做水平插值，结果为 dst_w * 3 个按 B, G, R 交错的 float。
+// order 给出 B, G, R 在源像素中的字节偏移。
+inline void interpolate_row(const uint8_t* src_row, const int* x_ofs0, const int* x_ofs1,
+                            const float* x_frac, const int order[3], int dst_w, float* out) {
+    const int b = order[0], g = order[1], r = order[2];
+    for (int x = 0; x < dst_w; ++x) {
+        const uint8_t* p0 = src_row + x_ofs0[x];
+        const uint8_t* p1 = src_row + x_ofs1[x];
+        const float fx = x_frac[x];
+        out[0] = p0[b] + fx * (float(p1[b]) - float(p0[b]));
+        out[1] = p0[g] + fx * (float(p1[g]) - float(p0[g]));
+        out[2] = p0[r] + fx * (float(p1[r]) - float(p0[r]));
+        out += 3;
+    }
+}
+
+inline void channel_order(PixelFormat format, int order[3]) {
+    switch (format) {
+        case PixelFormat::kRGB:
+        case PixelFormat::kRGBA:
+            order[0] = 2; order[1] = 1; order[2] = 0;
+            break;
+        case PixelFormat::kGray:
+            order[0] = 0; order[1] = 0; order[2] = 0;
+            break;
+        default:
+            order[0] = 0; order[1] = 1; order[2] = 2;
+            break;
+    }
+}
+
+// 与 cv::resize(INTER_LINEAR) 相同的半像素中心坐标映射
+inline void map_coordinate(int dst, double scale, int src_size, int& i0, int& i1, float& frac) {
+    double f = (dst + 0.5) * scale - 0.5;
+    int i = static_cast<int>(std::floor(f));
+    f -= i;
+    if (i < 0) {
+        i = 0;
+        f = 0.0;
+    }
+    if (i >= src_size - 1) {
+        i = src_size - 1;
+        f = 0.0;
+    }
+    i0 = i;
+    i1 = std::min(i + 1, src_size - 1);
+    frac = static_cast<float>(f);
+}
+
+} // namespace
+
+PreprocessEngine::PreprocessEngine() {
+    // ImageNet 均值和标准差，与 DeepLabV3 训练时一致
+    const float mean[3] = {0.485f, 0.456f, 0.406f};
+    const float std[3] = {0.229f, 0.224f, 0.225f};
+    this->set_normalization(mean, std);
+}
+
+void PreprocessEngine::set_normalization(const float mean[3], const float std[3]) {
+    // (v / 255 - mean) / std == v * (1 / (255 * std)) + (-mean / std)
+    for (int c = 0; c < 3; ++c) {
+        this->scale_[c] = 1.0f / (255.0f * std[c]);
+        this->bias_[c] = -mean[c] / std[c];
+    }
+}
+
+void PreprocessEngine::update_tables(int src_w, int src_h, int channels, int dst_w, int dst_h) {
+    if (src_w == this->src_w_ && src_h == this->src_h_ && channels == this->channels_ &&
+        dst_w == this->dst_w_ && dst_h == this->dst_h_) {
+        return;
+    }
+    this->src_w_ = src_w;
+    this->src_h_ = src_h;
+    this->channels_ = channels;
+    this->dst_w_ = dst_w;
+    this->dst_h_ = dst_h;
+
+    const double scale_x = static_cast<double>(src_w) / dst_w;
+    const double scale_y = static_cast<double>(src_h) / dst_h;
+
+    this->x_ofs0_.resize(dst_w);
+    this->x_ofs1_.resize(dst_w);
+    this->x_frac_.resize(dst_w);
+    for (int x = 0; x < dst_w; ++x) {
+        int x0, x1;
+        map_coordinate(x, scale_x, src_w, x0, x1, this->x_frac_[x]);
+        this->x_ofs0_[x] = x0 * channels;
+        this->x_ofs1_[x] = x1 * channels;
+    }
+
+    this->y_idx0_.resize(dst_h);
+    this->y_idx1_.resize(dst_h);
+    this->y_frac_.resize(dst_h);
+    for (int y = 0; y < dst_h; ++y) {
+        map_coordinate(y, scale_y, src_h, this->y_idx0_[y], this->y_idx1_[y], this->y_frac_[y]);
+    }
+}
+
+InputGeometry letterbox_geometry(const std::vector<ShapeBucket>& buckets, int width, int height) {
+    const ShapeBucket* best = nullptr;
+    double best_scale = 0.0;
+    for (const ShapeBucket& bucket : buckets) {
+        // Never upscale: a bucket that holds the image as is keeps it at scale 1
+        const double scale = std::min(1.0, std::min(static_cast<double>(bucket.width) / width,
+                                                    static_cast<double>(bucket.height) / height));
+        const int64_t area = static_cast<int64_t>(bucket.width) * bucket.height;
+        if (!best || scale > best_scale ||
+            (scale == best_scale && area < static_cast<int64_t>(best->width) * best->height)) {
+            best = &bucket;
+            best_scale = scale;
+        }
+    }
+
+    InputGeometry geometry;
+    geometry.input_width = best->width;
+    geometry.input_height = best->height;
+    geometry.content_width = std::clamp(static_cast<int>(std::lround(width * best_scale)), 1, best->width);
+    geometry.content_height = std::clamp(static_cast<int>(std::lround(height * best_scale)), 1, best->height);
+    return geometry;
+}
+
+void PreprocessEngine::run(const ImageView& src, float* dst, int dst_w, int dst_h) {
+    this->run(src, dst, dst_w, dst_h, dst_w, dst_h);
+}
+
+void PreprocessEngine::run(const ImageView& src, float* dst, int dst_w, int dst_h, int content_w, int content_h) {
+    this->update_tables(src.width, src.height, pixel_format_channels(src.format), content_w, content_h);
+
+    int order[3];
+    channel_order(src.format, order);
+
+    const size_t plane = static_cast<size_t>(dst_h) * dst_w;
+    const int num_blocks = (dst_h + kRowBlock - 1) / kRowBlock;
+
+    const PerfStageContext perf_owner = PerfStageContext::current();
+    cv::parallel_for_(cv::Range(0, num_blocks), [&](const cv::Range& range) {
+        ScopedWorkerCounters counters(perf_owner);
+        // 两行水平插值结果；相邻输出行共享源行时直接复用
+        std::vector<float> rows(static_cast<size_t>(content_w) * 3 * 2);
+        float* top = rows.data();
+        float* bottom = top + static_cast<size_t>(content_w) * 3;
+        int top_idx = -1, bottom_idx = -1;
+
+        for (int block = range.start; block < range.end; ++block) {
+            const int y_begin = block * kRowBlock;
+            const int y_end = std::min(y_begin + kRowBlock, dst_h);
+            for (int y = y_begin; y < y_end; ++y) {
+                float* out0 = dst + static_cast<size_t>(y) * dst_w;
+                float* out1 = out0 + plane;
+                float* out2 = out1 + plane;
+                if (y >= content_h) {
+                    // Letterbox padding below the image
+                    std::fill_n(out0, dst_w, 0.0f);
+                    std::fill_n(out1, dst_w, 0.0f);
+                    std::fill_n(out2, dst_w, 0.0f);
+                    continue;
+                }
+
+                const int y0 = this->y_idx0_[y];
+                const int y1 = this->y_idx1_[y];
+                if (y0 != top_idx) {
+                    if (y0 == bottom_idx) {
+                        std::swap(top, bottom);
+                        std::swap(top_idx, bottom_idx);
+                    } else {
+                        interpolate_row(src.data + y0 * src.stride, this->x_ofs0_.data(), this->x_ofs1_.data(),
+                                        this->x_frac_.data(), order, content_w, top);
+                        top_idx = y0;
+                    }
+                }
+                if (y1 != bottom_idx) {
+                    interpolate_row(src.data + y1 * src.stride, this->x_ofs0_.data(), this->x_ofs1_.data(),
+                                    this->x_frac_.data(), order, content_w, bottom);
+                    bottom_idx = y1;
+                }
+
+                const float fy = this->y_frac_[y];
+                const float* t = top;
+                const float* b = bottom;
+                for (int x = 0; x < content_w; ++x) {
+                    out0[x] = (t[0] + fy * (b[0] - t[0])) * this->scale_[0] + this->bias_[0];
+                    out1[x] = (t[1] + fy * (b[1] - t[1])) * this->scale_[1] + this->bias_[1];
+                    out2[x] = (t[2] + fy * (b[2] - t[2])) * this->scale_[2] + this->bias_[2];
+                    t += 3;
+                    b += 3;
+                }
+                // Letterbox padding to the right of the image
+                std::fill(out0 + content_w, out0 + dst_w, 0.0f);
+                std::fill(out1 + content_w, out1 + dst_w, 0.0f);
+                std::fill(out2 + content_w, out2 + dst_w, 0.0f);
+            }
+        }
+    });
+}
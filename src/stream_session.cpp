@@ -0,0 +1,105 @@
+#include "../include/stream_session.h"
+#include "../include/trt_segmentation_impl.h"
+
+#include <cstring>
+
+StreamSession::StreamSession(TRTSegmentation& owner, int width, PixelFormat format, int overlap, ArgmaxOutput mode)
+    : owner_(owner), width_(width), format_(format), mode_(mode), window_rows_(TRTSegmentation::kInputHeight),
+      step_rows_(TRTSegmentation::kInputHeight - overlap),
+      xs_(tile_positions(width, TRTSegmentation::kInputWidth, overlap)),
+      window_(TRTSegmentation::kInputHeight, width, CV_8UC(pixel_format_channels(format))),
+      stitcher_(width, TileStitcher::kUnboundedHeight, TRTSegmentation::kInputWidth, TRTSegmentation::kInputHeight, overlap) {}
+
+int StreamSession::push_rows(const uint8_t* rows, int num_rows, size_t stride) {
+    if (this->finished_) {
+        std::cerr << "Error: Stream already finished." << std::endl;
+        return -1;
+    }
+    const size_t row_bytes = static_cast<size_t>(this->width_) * pixel_format_channels(this->format_);
+    if (num_rows > 0 && stride < row_bytes) {
+        return -1;
+    }
+    for (int i = 0; i < num_rows;) {
+        const int n = std::min(num_rows - i, this->window_rows_ - this->filled_);
+        for (int r = 0; r < n; ++r) {
+            std::memcpy(this->window_.ptr(this->filled_ + r), rows + static_cast<size_t>(i + r) * stride, row_bytes);
+        }
+        this->filled_ += n;
+        i += n;
+        if (this->filled_ < this->window_rows_) {
+            break;
+        }
+
+        // Rows before the next window's start are final once this window is stitched in
+        if (this->run_window(this->window_y_ + this->step_rows_) != 0) {
+            return -1;
+        }
+        // Slide: the overlap rows move to the top of the window (destination rows are always above the source)
+        const int kept = this->window_rows_ - this->step_rows_;
+        std::memmove(this->window_.ptr(0), this->window_.ptr(this->step_rows_), static_cast<size_t>(kept) * this->window_.step);
+        this->filled_ = kept;
+        this->carried_ = kept;
+        this->window_y_ += this->step_rows_;
+    }
+    return 0;
+}
+
+int StreamSession::finish() {
+    if (this->finished_) {
+        return 0;
+    }
+    this->finished_ = true;
+    const int64_t total_rows = this->window_y_ + this->filled_;
+    this->stitcher_.set_height(total_rows);
+
+    // Carried rows were already covered by the previous window; only new rows need another pass
+    if (this->filled_ > this->carried_) {
+        return this->run_window(total_rows);
+    }
+    return this->emit(total_rows);
+}
+
+int StreamSession::run_window(int64_t emit_until) {
+    TraceRequestScope request(this->owner_.stats_.next_request_id());
+    ScopedStageTimer total(&this->owner_.stats_, kStageTimeTotal);
+    if (this->owner_.infer_tile_row(this->window_.rowRange(0, this->filled_), this->format_, this->xs_, this->window_y_,
+                                    this->mode_, this->stitcher_) != 0) {
+        return -1;
+    }
+    return this->emit(emit_until);
+}
+
+int StreamSession::emit(int64_t emit_until) {
+    const int64_t rows = emit_until - this->stitcher_.emitted_rows();
+    if (rows <= 0) {
+        return 0;
+    }
+    {
+        ScopedStageTimer timer(&this->owner_.stats_, kStageTimePostprocess);
+        this->scratch_.resize(static_cast<size_t>(rows) * this->width_);
+        this->stitcher_.emit(emit_until, this->scratch_.data(), this->width_, this->mode_);
+    }
+
+    std::lock_guard<std::mutex> lock(this->mask_mutex_);
+    // Drop rows that were already popped before growing the queue
+    if (this->mask_head_ > 0) {
+        this->mask_rows_.erase(this->mask_rows_.begin(), this->mask_rows_.begin() + this->mask_head_ * this->width_);
+        this->mask_head_ = 0;
+    }
+    this->mask_rows_.insert(this->mask_rows_.end(), this->scratch_.begin(), this->scratch_.end());
+    return 0;
+}
+
+int StreamSession::pop_mask_rows(uint8_t* mask, int max_rows, size_t stride) {
+    if (max_rows > 0 && stride < static_cast<size_t>(this->width_)) {
+        return -1;
+    }
+    std::lock_guard<std::mutex> lock(this->mask_mutex_);
+    const size_t available = this->mask_rows_.size() / this->width_ - this->mask_head_;
+    const size_t n = std::min(available, static_cast<size_t>(std::max(max_rows, 0)));
+    for (size_t r = 0; r < n; ++r) {
+        std::memcpy(mask + r * stride, this->mask_rows_.data() + (this->mask_head_ + r) * this->width_, this->width_);
+    }
+    this->mask_head_ += n;
+    return static_cast<int>(n);
+}
@@ -0,0 +1,264 @@
+#include "../include/engine_registry.h"
+#include "../include/inference_backend.h"
+
+#include <cuda_runtime.h>
+
+#include <climits>
+#include <iostream>
+#include <vector>
+
+namespace {
+
+// cudaMalloc / cudaFree
+class CudaDeviceAllocator : public IAllocator {
+public:
+    void* allocate(size_t bytes) override {
+        void* ptr = nullptr;
+        if (cudaMalloc(&ptr, bytes) != cudaSuccess) return nullptr;
+        return ptr;
+    }
+    void deallocate(void* ptr) override { cudaFree(ptr); }
+};
+
+// cudaMallocHost 分配的锁页内存，H2D/D2H 拷贝无需额外的中转
+class CudaPinnedAllocator : public IAllocator {
+public:
+    void* allocate(size_t bytes) override {
+        void* ptr = nullptr;
+        if (cudaMallocHost(&ptr, bytes) != cudaSuccess) return nullptr;
+        return ptr;
+    }
+    void deallocate(void* ptr) override { cudaFreeHost(ptr); }
+};
+
+CudaDeviceAllocator g_device_allocator;
+CudaPinnedAllocator g_pinned_allocator;
+
+TensorShape to_shape(const nvinfer1::Dims& dims) {
+    return TensorShape(dims.d, dims.d + dims.nbDims);
+}
+
+nvinfer1::Dims to_dims(const TensorShape& shape) {
+    nvinfer1::Dims dims{};
+    dims.nbDims = static_cast<int32_t>(shape.size());
+    for (size_t i = 0; i < shape.size(); ++i) dims.d[i] = shape[i];
+    return dims;
+}
+
+bool to_tensor_type(nvinfer1::DataType type, TensorDataType& out) {
+    switch (type) {
+        case nvinfer1::DataType::kFLOAT: out = TensorDataType::kFloat32; return true;
+        case nvinfer1::DataType::kHALF: out = TensorDataType::kFloat16; return true;
+        case nvinfer1::DataType::kINT32: out = TensorDataType::kInt32; return true;
+        case nvinfer1::DataType::kINT64: out = TensorDataType::kInt64; return true;
+        case nvinfer1::DataType::kUINT8: out = TensorDataType::kUint8; return true;
+        default: return false;
+    }
+}
+
+struct TensorInfo {
+    std::string name;
+    TensorDataType type = TensorDataType::kFloat32;
+    bool is_input = false;
+};
+
+class TensorRTContext : public BackendContext {
+public:
+    TensorRTContext(std::shared_ptr<SharedEngine> shared, const std::vector<TensorInfo>& tensors, int input_index, int output_index)
+        : shared_(std::move(shared)), tensors_(tensors), input_index_(input_index), output_index_(output_index),
+          device_buffers_(g_device_allocator), host_buffers_(g_pinned_allocator) {}
+
+    // 执行上下文和缓冲区必须先于引擎销毁
+    ~TensorRTContext() override {
+        this->device_buffers_.release_all();
+        this->host_buffers_.release_all();
+        this->context_.reset();
+    }
+
+    bool create() {
+        std::lock_guard<std::mutex> lock(this->shared_->context_mutex);
+        this->context_.reset(this->shared_->engine->createExecutionContext());
+        if (!this->context_) {
+            std::cerr << "Error: Failed to create execution context." << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    bool set_input_shape(const TensorShape& shape) override {
+        const TensorInfo& input = this->tensors_[this->input_index_];
+        const TensorInfo& output = this->tensors_[this->output_index_];
+        if (!this->context_->setInputShape(input.name.c_str(), to_dims(shape))) {
+            std::cerr << "Error: Failed to set input shape." << std::endl;
+            return false;
+        }
+
+        // Bind pooled buffers; they are only reallocated when a larger shape arrives
+        this->bindings_.assign(this->tensors_.size(), nullptr);
+        for (size_t i = 0; i < this->tensors_.size(); ++i) {
+            const TensorInfo& tensor = this->tensors_[i];
+            const TensorShape tensor_shape = to_shape(this->context_->getTensorShape(tensor.name.c_str()));
+            this->bindings_[i] = this->device_buffers_.acquire(tensor.name, tensor_shape, tensor.type);
+            if (!this->bindings_[i]) {
+                std::cerr << "Error: Failed to allocate device buffer for " << tensor.name << std::endl;
+                return false;
+            }
+        }
+
+        this->input_shape_ = shape;
+        this->output_shape_ = to_shape(this->context_->getTensorShape(output.name.c_str()));
+        this->host_input_ = static_cast<float*>(this->host_buffers_.acquire(input.name, this->input_shape_, input.type));
+        this->host_output_ = this->host_buffers_.acquire(output.name, this->output_shape_, output.type);
+        if (!this->host_input_ || !this->host_output_) {
+            std::cerr << "Error: Failed to allocate host staging buffers." << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    float* input() override { return this->host_input_; }
+
+    bool execute() override {
+        const TensorInfo& input = this->tensors_[this->input_index_];
+        const TensorInfo& output = this->tensors_[this->output_index_];
+        {
+            ScopedStageTimer timer(this->stats_, kStageTimeH2D);
+            cudaMemcpy(this->bindings_[this->input_index_], this->host_input_,
+                       shape_volume(this->input_shape_) * data_type_size(input.type), cudaMemcpyHostToDevice);
+        }
+        {
+            ScopedStageTimer timer(this->stats_, kStageTimeExecute);
+            if (!this->context_->executeV2(this->bindings_.data())) {
+                std::cerr << "Error: Failed to execute inference." << std::endl;
+                return false;
+            }
+        }
+        {
+            ScopedStageTimer timer(this->stats_, kStageTimeD2H);
+            cudaMemcpy(this->host_output_, this->bindings_[this->output_index_],
+                       shape_volume(this->output_shape_) * data_type_size(output.type), cudaMemcpyDeviceToHost);
+        }
+        return true;
+    }
+
+    TensorShape output_shape() const override { return this->output_shape_; }
+    TensorDataType output_type() const override { return this->tensors_[this->output_index_].type; }
+    const void* output() const override { return this->host_output_; }
+
+    void buffer_stats(BufferPoolStats& device, BufferPoolStats& host) const override {
+        device = this->device_buffers_.stats();
+        host = this->host_buffers_.stats();
+    }
+
+private:
+    std::shared_ptr<SharedEngine> shared_;
+    const std::vector<TensorInfo>& tensors_;
+    const int input_index_;
+    const int output_index_;
+
+    std::unique_ptr<nvinfer1::IExecutionContext> context_;
+    BufferPool device_buffers_;
+    BufferPool host_buffers_;
+    std::vector<void*> bindings_;
+
+    TensorShape input_shape_;
+    TensorShape output_shape_;
+    float* host_input_ = nullptr;
+    void* host_output_ = nullptr;
+};
+
+class TensorRTBackend : public InferenceBackend {
+public:
+    explicit TensorRTBackend(std::shared_ptr<SharedEngine> shared) : shared_(std::move(shared)) {}
+
+    // Get tensor names and types; buffers are allocated per context on first use
+    bool discover() {
+        nvinfer1::ICudaEngine* engine = this->shared_->engine.get();
+        for (int i = 0; i < engine->getNbIOTensors(); ++i) {
+            TensorInfo tensor;
+            tensor.name = engine->getIOTensorName(i);
+            tensor.is_input = engine->getTensorIOMode(tensor.name.c_str()) == nvinfer1::TensorIOMode::kINPUT;
+            if (!to_tensor_type(engine->getTensorDataType(tensor.name.c_str()), tensor.type)) {
+                std::cerr << "Error: Unsupported data type for tensor " << tensor.name << std::endl;
+                return false;
+            }
+            (tensor.is_input ? this->input_index_ : this->output_index_) = i;
+            this->tensors_.push_back(tensor);
+        }
+
+        if (this->input_index_ < 0 || this->output_index_ < 0) {
+            std::cerr << "Error: Could not find input or output tensors." << std::endl;
+            return false;
+        }
+        if (this->tensors_[this->input_index_].type != TensorDataType::kFloat32) {
+            std::cerr << "Error: Only float32 engine inputs are supported." << std::endl;
+            return false;
+        }
+
+        // Largest batch the engine accepts: fixed batch dim, or the max of optimization profile 0
+        const char* input_name = this->tensors_[this->input_index_].name.c_str();
+        nvinfer1::Dims input_shape = engine->getTensorShape(input_name);
+        if (input_shape.nbDims > 0 && input_shape.d[0] < 0) {
+            nvinfer1::Dims max_shape = engine->getProfileShape(input_name, 0, nvinfer1::OptProfileSelector::kMAX);
+            this->max_batch_ = max_shape.nbDims > 0 ? static_cast<int>(max_shape.d[0]) : 1;
+        } else {
+            this->max_batch_ = input_shape.nbDims > 0 ? static_cast<int>(input_shape.d[0]) : 1;
+        }
+
+        // Spatial range of profile 0 (the one every context uses); fixed dims are their own range
+        if (input_shape.nbDims == 4) {
+            nvinfer1::Dims min_shape = input_shape, max_shape = input_shape;
+            if (input_shape.d[2] < 0 || input_shape.d[3] < 0) {
+                min_shape = engine->getProfileShape(input_name, 0, nvinfer1::OptProfileSelector::kMIN);
+                max_shape = engine->getProfileShape(input_name, 0, nvinfer1::OptProfileSelector::kMAX);
+            }
+            this->min_size_[0] = static_cast<int>(min_shape.d[2]);
+            this->min_size_[1] = static_cast<int>(min_shape.d[3]);
+            this->max_size_[0] = static_cast<int>(max_shape.d[2]);
+            this->max_size_[1] = static_cast<int>(max_shape.d[3]);
+        }
+        return true;
+    }
+
+    const char* name() const override { return "tensorrt"; }
+    int max_batch_size() const override { return this->max_batch_; }
+    bool accepts_input_size(int height, int width) const override {
+        return height >= this->min_size_[0] && height <= this->max_size_[0] &&
+               width >= this->min_size_[1] && width <= this->max_size_[1];
+    }
+
+    std::unique_ptr<BackendContext> create_context() override {
+        auto context = std::make_unique<TensorRTContext>(this->shared_, this->tensors_, this->input_index_, this->output_index_);
+        if (!context->create()) return nullptr;
+        return context;
+    }
+
+private:
+    // 可能与其他句柄共享
+    std::shared_ptr<SharedEngine> shared_;
+    std::vector<TensorInfo> tensors_;
+    int input_index_ = -1;
+    int output_index_ = -1;
+    int max_batch_ = 1;
+    // 输入的 (H, W) 范围
+    int min_size_[2] = {0, 0};
+    int max_size_[2] = {INT_MAX, INT_MAX};
+};
+
+std::unique_ptr<InferenceBackend> make_backend(std::shared_ptr<SharedEngine> shared) {
+    if (!shared) return nullptr;
+    auto backend = std::make_unique<TensorRTBackend>(std::move(shared));
+    if (!backend->discover()) return nullptr;
+    return backend;
+}
+
+} // namespace
+
+std::unique_ptr<InferenceBackend> create_tensorrt_backend(const std::string& engine_path) {
+    // Handles created for the same engine file share one deserialized engine
+    return make_backend(EngineRegistry::instance().acquire(engine_path));
+}
+
+std::unique_ptr<InferenceBackend> create_tensorrt_backend(const void* engine_data, size_t engine_size) {
+    return make_backend(load_engine(engine_data, engine_size));
+}
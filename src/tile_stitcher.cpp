@@ -0,0 +1,91 @@
+#include "../include/tile_stitcher.h"
+#include "../include/inference_stats.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include <opencv2/opencv.hpp>
+
+std::vector<int> tile_positions(int length, int tile, int overlap) {
+    if (length <= tile) {
+        return {0};
+    }
+    // Fewest tiles whose stride (tile - overlap) covers the length, then spread them evenly
+    const int stride = std::max(tile - overlap, 1);
+    const int count = (length - tile + stride - 1) / stride + 1;
+    std::vector<int> positions(count);
+    const int last = length - tile;
+    for (int i = 0; i < count; ++i) {
+        positions[i] = static_cast<int>(static_cast<int64_t>(last) * i / (count - 1));
+    }
+    return positions;
+}
+
+namespace {
+
+// Linear ramp 1, 2, ..., ramp at both ends of the tile, flat in between; never zero
+std::vector<float> ramp_weights(int tile, int overlap) {
+    const int ramp = std::max(overlap, 0) + 1;
+    std::vector<float> weights(tile);
+    for (int i = 0; i < tile; ++i) {
+        weights[i] = static_cast<float>(std::min({i + 1, tile - i, ramp}));
+    }
+    return weights;
+}
+
+} // namespace
+
+TileStitcher::TileStitcher(int width, int64_t height, int tile_width, int tile_height, int overlap)
+    : width_(width), height_(height), tile_width_(tile_width), tile_height_(tile_height),
+      weight_x_(ramp_weights(tile_width, overlap)), weight_y_(ramp_weights(tile_height, overlap)) {}
+
+void TileStitcher::add(int x, int64_t y, const float* logits, const TensorShape& shape) {
+    const int num_classes = static_cast<int>(shape[1]);
+    const int out_height = static_cast<int>(shape[2]);
+    const int out_width = static_cast<int>(shape[3]);
+    if (this->accumulator_.empty()) {
+        this->num_classes_ = num_classes;
+        this->row_floats_ = static_cast<size_t>(num_classes) * this->width_;
+        this->accumulator_.assign(this->row_floats_ * this->tile_height_, 0.0f);
+    }
+
+    const size_t plane = static_cast<size_t>(out_height) * out_width;
+    const int rows = static_cast<int>(std::min<int64_t>(this->tile_height_, this->height_ - y));
+    const int cols = std::min(this->tile_width_, this->width_ - x);
+
+    // Nearest source column for every tile column (identity when the model keeps the resolution)
+    std::vector<int> src_x(cols);
+    for (int tx = 0; tx < cols; ++tx) src_x[tx] = static_cast<int>(static_cast<int64_t>(tx) * out_width / this->tile_width_);
+
+    for (int ty = 0; ty < rows; ++ty) {
+        const int sy = static_cast<int>(static_cast<int64_t>(ty) * out_height / this->tile_height_);
+        const float wy = this->weight_y_[ty];
+        float* acc_row = this->row(y + ty) + x;
+        for (int c = 0; c < num_classes; ++c) {
+            const float* src = logits + c * plane + static_cast<size_t>(sy) * out_width;
+            float* dst = acc_row + static_cast<size_t>(c) * this->width_;
+            for (int tx = 0; tx < cols; ++tx) {
+                dst[tx] += wy * this->weight_x_[tx] * src[src_x[tx]];
+            }
+        }
+    }
+}
+
+void TileStitcher::emit(int64_t y_end, uint8_t* mask, size_t mask_stride, ArgmaxOutput mode) {
+    y_end = std::min(y_end, this->height_);
+    if (y_end <= this->emitted_ || this->accumulator_.empty()) {
+        return;
+    }
+    const int64_t begin = this->emitted_;
+    const PerfStageContext perf_owner = PerfStageContext::current();
+    cv::parallel_for_(cv::Range(0, static_cast<int>(y_end - begin)), [&](const cv::Range& rows) {
+        ScopedWorkerCounters counters(perf_owner);
+        for (int i = rows.start; i < rows.end; ++i) {
+            float* acc = this->row(begin + i);
+            argmax_planar(acc, this->num_classes_, this->width_, this->width_, mask + static_cast<size_t>(i) * mask_stride, mode);
+            // The ring slot is reused by the row tile_height further down
+            std::memset(acc, 0, this->row_floats_ * sizeof(float));
+        }
+    });
+    this->emitted_ = y_end;
+}
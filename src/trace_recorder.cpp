@@ -0,0 +1,92 @@
+#include "../include/trace_recorder.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+
+thread_local uint64_t TraceRequestScope::current_ = 0;
+
+namespace {
+
+std::atomic<uint64_t> g_next_recorder_id{1};
+
+// 最近使用的记录器及本线程在其中的缓冲区；绝大多数线程只服务一个句柄，所以一项就够了
+struct ThreadCache {
+    uint64_t recorder_id = 0;
+    void* buffer = nullptr;
+};
+thread_local ThreadCache t_cache;
+
+} // namespace
+
+TraceRecorder::TraceRecorder() : id_(g_next_recorder_id.fetch_add(1)), origin_(Clock::now()) {}
+
+TraceRecorder::~TraceRecorder() = default;
+
+void TraceRecorder::enable(size_t events_per_thread) {
+    std::lock_guard<std::mutex> lock(this->mutex_);
+    this->events_per_thread_ = std::max<size_t>(events_per_thread, 1);
+    this->enabled_at_ns_.store(this->to_ns(Clock::now()), std::memory_order_relaxed);
+    this->enabled_.store(true, std::memory_order_release);
+}
+
+void TraceRecorder::disable() {
+    this->enabled_.store(false, std::memory_order_release);
+}
+
+TraceRecorder::ThreadBuffer* TraceRecorder::thread_buffer() {
+    if (t_cache.recorder_id == this->id_) {
+        return static_cast<ThreadBuffer*>(t_cache.buffer);
+    }
+
+    // Slow path: first event from this thread, or the thread switched handles
+    std::lock_guard<std::mutex> lock(this->mutex_);
+    std::unique_ptr<ThreadBuffer>& buffer = this->buffers_[std::this_thread::get_id()];
+    if (!buffer) {
+        buffer = std::make_unique<ThreadBuffer>(this->events_per_thread_, static_cast<int>(this->buffers_.size()));
+    }
+    t_cache.recorder_id = this->id_;
+    t_cache.buffer = buffer.get();
+    return buffer.get();
+}
+
+bool TraceRecorder::dump(const std::string& path) const {
+    std::ofstream out(path);
+    if (!out) {
+        std::cerr << "Error: Could not write trace file: " << path << std::endl;
+        return false;
+    }
+
+    const uint64_t enabled_at = this->enabled_at_ns_.load(std::memory_order_relaxed);
+    std::lock_guard<std::mutex> lock(this->mutex_);
+
+    out << std::fixed << std::setprecision(3); // microseconds with nanosecond resolution
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    bool first = true;
+    for (const auto& entry : this->buffers_) {
+        const ThreadBuffer& buffer = *entry.second;
+        out << (first ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer.index
+            << ",\"args\":{\"name\":\"worker " << buffer.index << "\"}}";
+        first = false;
+
+        const uint64_t head = buffer.head.load(std::memory_order_acquire);
+        const uint64_t capacity = buffer.events.size();
+        for (uint64_t i = head > capacity ? head - capacity : 0; i < head; ++i) {
+            const Event& e = buffer.events[i % capacity];
+            if (e.seq.load(std::memory_order_acquire) != i + 1) continue; // being overwritten
+            const uint64_t begin = e.begin_ns.load(std::memory_order_relaxed);
+            const uint64_t end = e.end_ns.load(std::memory_order_relaxed);
+            const uint64_t request = e.request.load(std::memory_order_relaxed);
+            const char* name = e.name.load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (e.seq.load(std::memory_order_relaxed) != i + 1 || !name || begin < enabled_at) continue;
+
+            out << ",\n{\"name\":\"" << name << "\",\"cat\":\"stage\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer.index
+                << ",\"ts\":" << begin / 1000.0 << ",\"dur\":" << (end - begin) / 1000.0
+                << ",\"args\":{\"request\":" << request << "}}";
+        }
+    }
+    out << "\n]}\n";
+    return static_cast<bool>(out);
+}
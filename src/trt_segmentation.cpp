@@ -1,180 +1,1049 @@
 #include "../include/trt_segmentation_impl.h"
 
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+// Threads for file reads/decodes and encodes/writes; these mostly wait on the disk
+size_t default_io_threads() {
+    const size_t hw = std::thread::hardware_concurrency();
+    return std::min<size_t>(std::max<size_t>(hw / 2, 2), 8);
+}
+
+bool is_label_map(TensorDataType type) {
+    return type == TensorDataType::kInt32 || type == TensorDataType::kInt64 || type == TensorDataType::kUint8;
+}
+
+// Class scores are NCHW; label maps (argmax exported into the model) are NHW or N1HW
+bool output_layout(const TensorShape& shape, TensorDataType type, OutputLayout& layout) {
+    if (!is_label_map(type)) {
+        if (shape.size() != 4) return false;
+        layout.num_classes = static_cast<int>(shape[1]);
+        layout.height = static_cast<int>(shape[2]);
+        layout.width = static_cast<int>(shape[3]);
+    } else if (shape.size() == 3) {
+        layout.num_classes = 1;
+        layout.height = static_cast<int>(shape[1]);
+        layout.width = static_cast<int>(shape[2]);
+    } else if (shape.size() == 4 && shape[1] == 1) {
+        layout.num_classes = 1;
+        layout.height = static_cast<int>(shape[2]);
+        layout.width = static_cast<int>(shape[3]);
+    } else {
+        return false;
+    }
+    layout.row_stride = static_cast<size_t>(layout.width);
+    layout.plane = static_cast<size_t>(layout.height) * layout.width;
+    return layout.num_classes > 0;
+}
+
+// Restricts the layout to the output cells covering the letterboxed image; the padding is dropped
+// before the upscale, so the mask maps back onto the original image without distortion
+OutputLayout content_layout(const OutputLayout& layout, const InputGeometry& geometry) {
+    OutputLayout content = layout;
+    const int64_t cells_w = static_cast<int64_t>(geometry.content_width) * layout.width;
+    const int64_t cells_h = static_cast<int64_t>(geometry.content_height) * layout.height;
+    content.width = static_cast<int>((cells_w + geometry.input_width - 1) / geometry.input_width);
+    content.height = static_cast<int>((cells_h + geometry.input_height - 1) / geometry.input_height);
+    return content;
+}
+
+// Per-type kernels for a run of count pixels
+inline void scores_to_output(const float* scores, int num_classes, size_t plane, size_t count, uint8_t* out, ArgmaxOutput mode) {
+    argmax_planar(scores, num_classes, plane, count, out, mode);
+}
+
+inline void scores_to_output(const uint16_t* scores, int num_classes, size_t plane, size_t count, uint8_t* out, ArgmaxOutput mode) {
+    argmax_planar_f16(scores, num_classes, plane, count, out, mode);
+}
+
+inline void scores_to_output(const float* scores, int num_classes, size_t plane, size_t count, uint8_t* out, ArgmaxOutput mode,
+                             float* confidence) {
+    argmax_confidence_planar(scores, num_classes, plane, count, out, mode, confidence);
+}
+
+inline void scores_to_output(const uint16_t* scores, int num_classes, size_t plane, size_t count, uint8_t* out, ArgmaxOutput mode,
+                             float* confidence) {
+    argmax_confidence_planar_f16(scores, num_classes, plane, count, out, mode, confidence);
+}
+
+// Destinations for the final-resolution rows of postprocess. store() writes row dy from a
+// model-resolution line (src_x maps every destination column to a line index, or is null when the
+// widths match); copy() duplicates a finished row for the rows that sample the same source row.
+struct ByteMaskRows {
+    static constexpr bool kDirect = true; // row_fn can write straight into the mask when sizes match
+    cv::Mat& mask;
+
+    int width() const { return this->mask.cols; }
+    int height() const { return this->mask.rows; }
+    uint8_t* direct(int y) { return this->mask.ptr(y); }
+    size_t line_bytes(int src_width) const { return static_cast<size_t>(src_width); }
+    void store(int dy, const uint8_t* line, const int* src_x) {
+        uint8_t* dst = this->mask.ptr(dy);
+        for (int x = 0; x < this->mask.cols; ++x) dst[x] = line[src_x[x]];
+    }
+    void copy(int from, int to) { std::memcpy(this->mask.ptr(to), this->mask.ptr(from), static_cast<size_t>(this->mask.cols)); }
+};
+
+struct PackedMaskRows {
+    static constexpr bool kDirect = false; // bits are packed from the line buffer
+    PackedMask& packed;
+
+    int width() const { return this->packed.width; }
+    int height() const { return this->packed.height; }
+    size_t line_bytes(int src_width) const { return static_cast<size_t>(src_width); }
+    void store(int dy, const uint8_t* line, const int* src_x) { pack_row(line, src_x, this->packed.width, this->packed.row(dy)); }
+    void copy(int from, int to) { std::memcpy(this->packed.row(to), this->packed.row(from), this->packed.stride); }
+};
+
+// Labels plus a per-pixel confidence plane (CV_8UC1 quantized, or CV_16UC1 holding fp16 bits).
+// The line holds the labels first and the confidences from confidence_offset() on.
+struct ConfidenceMaskRows {
+    static constexpr bool kDirect = false;
+    cv::Mat& mask;
+    cv::Mat& confidence;
+    int src_width;
+
+    int width() const { return this->mask.cols; }
+    int height() const { return this->mask.rows; }
+    bool half() const { return this->confidence.elemSize() == 2; }
+    size_t confidence_offset() const { return (static_cast<size_t>(this->src_width) + 15) & ~static_cast<size_t>(15); }
+    size_t line_bytes(int columns) const { return this->confidence_offset() + static_cast<size_t>(columns) * this->confidence.elemSize(); }
+    void store(int dy, const uint8_t* line, const int* src_x) {
+        uint8_t* dst = this->mask.ptr(dy);
+        for (int x = 0; x < this->mask.cols; ++x) dst[x] = line[src_x[x]];
+        const uint8_t* conf = line + this->confidence_offset();
+        if (this->half()) {
+            const uint16_t* src = reinterpret_cast<const uint16_t*>(conf);
+            uint16_t* out = this->confidence.ptr<uint16_t>(dy);
+            for (int x = 0; x < this->mask.cols; ++x) out[x] = src[src_x[x]];
+        } else {
+            uint8_t* out = this->confidence.ptr(dy);
+            for (int x = 0; x < this->mask.cols; ++x) out[x] = conf[src_x[x]];
+        }
+    }
+    void copy(int from, int to) {
+        std::memcpy(this->mask.ptr(to), this->mask.ptr(from), static_cast<size_t>(this->mask.cols));
+        std::memcpy(this->confidence.ptr(to), this->confidence.ptr(from), this->mask.cols * this->confidence.elemSize());
+    }
+};
+
+// Calls row_fn(y, out) to produce model-resolution row y. When the destination has another size
+// (the original image), each row is produced once into a small line buffer and expanded with
+// nearest-neighbour index maps straight into every destination row that samples it, so there is no
+// intermediate low-resolution image and no second pass. Rows no destination row samples are skipped.
+// The mapping matches cv::resize INTER_NEAREST: src = floor(dst * src_size / dst_size).
+// With components set, every produced row is also fed to a run-based labeller while it is hot.
+template <typename Rows, typename RowFn>
+void write_mask(const OutputLayout& layout, Rows rows, RowFn row_fn, ComponentSet* components) {
+    const int64_t src_w = layout.width;
+    const int64_t src_h = layout.height;
+    const int64_t dst_w = rows.width();
+    const int64_t dst_h = rows.height();
+    const PerfStageContext perf_owner = PerfStageContext::current();
+    if constexpr (Rows::kDirect) {
+        if (dst_w == src_w && dst_h == src_h) {
+            std::unique_ptr<ComponentLabeller> labeller;
+            if (components) labeller = std::make_unique<ComponentLabeller>(ColumnGrid::identity(layout.width));
+            // Rows are split across threads so each worker streams a contiguous slice of every plane
+            cv::parallel_for_(cv::Range(0, layout.height), [&](const cv::Range& range) {
+                ScopedWorkerCounters counters(perf_owner);
+                ComponentLabeller::Chunk* chunk = labeller ? labeller->begin_chunk(range.start) : nullptr;
+                for (int y = range.start; y < range.end; ++y) {
+                    uint8_t* out = rows.direct(y);
+                    row_fn(y, out);
+                    if (chunk) chunk->add_row(out, y, y + 1);
+                }
+            });
+            if (labeller) labeller->finish(components->min_area, components->items);
+            return;
+        }
+    }
+
+    std::vector<int> src_x(static_cast<size_t>(dst_w));
+    for (int64_t x = 0; x < dst_w; ++x) src_x[x] = static_cast<int>(x * src_w / dst_w);
+    // Components are labelled on the grid of sampled source cells, which the upscale only enlarges
+    std::unique_ptr<ComponentLabeller> labeller;
+    if (components) labeller = std::make_unique<ComponentLabeller>(ColumnGrid::from_map(src_x.data(), static_cast<int>(dst_w)));
+
+    cv::parallel_for_(cv::Range(0, layout.height), [&](const cv::Range& range) {
+        ScopedWorkerCounters counters(perf_owner);
+        ComponentLabeller::Chunk* chunk = labeller ? labeller->begin_chunk(range.start) : nullptr;
+        std::vector<uint8_t> line(rows.line_bytes(layout.width));
+        for (int sy = range.start; sy < range.end; ++sy) {
+            // Destination rows whose nearest source row is sy
+            const int dy0 = static_cast<int>((sy * dst_h + src_h - 1) / src_h);
+            const int dy1 = static_cast<int>(((sy + 1) * dst_h + src_h - 1) / src_h);
+            if (dy0 >= dy1) continue;
+
+            row_fn(sy, line.data());
+            rows.store(dy0, line.data(), src_x.data());
+            for (int dy = dy0 + 1; dy < dy1; ++dy) rows.copy(dy0, dy);
+            if (chunk) chunk->add_row(line.data(), dy0, dy1);
+        }
+    });
+    if (labeller) labeller->finish(components->min_area, components->items);
+}
+
+template <typename T, typename Rows>
+void postprocess_scores(const T* scores, const OutputLayout& layout, Rows rows, ArgmaxOutput mode, ComponentSet* components) {
+    write_mask(layout, rows, [&](int y, uint8_t* out) {
+        scores_to_output(scores + y * layout.row_stride, layout.num_classes, layout.plane, layout.width, out, mode);
+    }, components);
+}
+
+template <typename T, typename Rows>
+void postprocess_labels(const T* labels, const OutputLayout& layout, Rows rows, ArgmaxOutput mode, ComponentSet* components) {
+    // No argmax at all: a narrowing copy or threshold per row
+    write_mask(layout, rows, [&](int y, uint8_t* out) {
+        labels_to_output(labels + y * layout.row_stride, layout.width, out, mode);
+    }, components);
+}
+
+// Labels and softmax confidence from class scores in one pass over the planes
+template <typename T>
+void postprocess_confidence(const T* scores, const OutputLayout& layout, ConfidenceMaskRows rows, ArgmaxOutput mode,
+                            ComponentSet* components) {
+    write_mask(layout, rows, [&](int y, uint8_t* out) {
+        thread_local std::vector<float> probability;
+        probability.resize(layout.width);
+        scores_to_output(scores + y * layout.row_stride, layout.num_classes, layout.plane, layout.width, out, mode,
+                         probability.data());
+        uint8_t* conf = out + rows.confidence_offset();
+        if (rows.half()) {
+            float_to_half(probability.data(), reinterpret_cast<uint16_t*>(conf), layout.width);
+        } else {
+            quantize_unit_u8(probability.data(), conf, layout.width);
+        }
+    }, components);
+}
+
+template <typename T>
+void postprocess_labels_confidence(const T* labels, const OutputLayout& layout, ConfidenceMaskRows rows, ArgmaxOutput mode,
+                                   ComponentSet* components) {
+    // A label map carries no probabilities; every pixel reports full confidence
+    write_mask(layout, rows, [&](int y, uint8_t* out) {
+        labels_to_output(labels + y * layout.row_stride, layout.width, out, mode);
+        uint8_t* conf = out + rows.confidence_offset();
+        if (rows.half()) {
+            std::fill_n(reinterpret_cast<uint16_t*>(conf), layout.width, static_cast<uint16_t>(0x3c00)); // 1.0
+        } else {
+            std::memset(conf, 255, static_cast<size_t>(layout.width));
+        }
+    }, components);
+}
+
+void postprocess_confidence_rows(const void* output, TensorDataType type, const OutputLayout& layout, ConfidenceMaskRows rows,
+                                 ArgmaxOutput mode, ComponentSet* components) {
+    switch (type) {
+        case TensorDataType::kFloat32: postprocess_confidence(static_cast<const float*>(output), layout, rows, mode, components); break;
+        case TensorDataType::kFloat16: postprocess_confidence(static_cast<const uint16_t*>(output), layout, rows, mode, components); break;
+        case TensorDataType::kInt32: postprocess_labels_confidence(static_cast<const int32_t*>(output), layout, rows, mode, components); break;
+        case TensorDataType::kInt64: postprocess_labels_confidence(static_cast<const int64_t*>(output), layout, rows, mode, components); break;
+        case TensorDataType::kUint8: postprocess_labels_confidence(static_cast<const uint8_t*>(output), layout, rows, mode, components); break;
+    }
+}
+
+template <typename Rows>
+void postprocess_rows(const void* output, TensorDataType type, const OutputLayout& layout, Rows rows, ArgmaxOutput mode,
+                      ComponentSet* components) {
+    switch (type) {
+        case TensorDataType::kFloat32: postprocess_scores(static_cast<const float*>(output), layout, rows, mode, components); break;
+        case TensorDataType::kFloat16: postprocess_scores(static_cast<const uint16_t*>(output), layout, rows, mode, components); break;
+        case TensorDataType::kInt32: postprocess_labels(static_cast<const int32_t*>(output), layout, rows, mode, components); break;
+        case TensorDataType::kInt64: postprocess_labels(static_cast<const int64_t*>(output), layout, rows, mode, components); break;
+        case TensorDataType::kUint8: postprocess_labels(static_cast<const uint8_t*>(output), layout, rows, mode, components); break;
+    }
+}
+
+} // namespace
+
 TRTSegmentation::~TRTSegmentation() {
-    for (void* buffer : buffers_) {
-        cudaFree(buffer);
+    // Drain in-flight pipeline items and pending batches first,
+    // then contexts (and their buffers) must go before the engine
+    this->pipeline_.reset();
+    this->scheduler_.reset();
+    if (!this->trace_dump_path_.empty()) {
+        this->dump_trace(this->trace_dump_path_);
     }
+    this->slots_.clear();
 }
 
-int TRTSegmentation::init(const std::string& engine_path) {
-    std::ifstream engine_file(engine_path, std::ios::binary);
-    if (!engine_file.is_open()) {
-        std::cerr << "Error: Could not open engine file: " << engine_path << std::endl;
+int TRTSegmentation::set_num_contexts(int num_contexts) {
+    if (num_contexts < 1 || this->backend_) {
         return -1;
     }
+    this->num_contexts_ = num_contexts;
+    return 0;
+}
 
-    engine_file.seekg(0, engine_file.end);
-    long int fsize = engine_file.tellg();
-    engine_file.seekg(0, engine_file.beg);
+int TRTSegmentation::set_backend(BackendKind kind) {
+    if (this->backend_) {
+        return -1;
+    }
+    this->backend_kind_ = kind;
+    return 0;
+}
+
+void TRTSegmentation::buffer_stats(BufferPoolStats& device, BufferPoolStats& host) const {
+    device = BufferPoolStats();
+    host = BufferPoolStats();
+    this->slots_.for_each([&](const InferenceSlot& slot) {
+        BufferPoolStats slot_device, slot_host;
+        slot.context->buffer_stats(slot_device, slot_host);
+        accumulate(device, slot_device);
+        accumulate(host, slot_host);
+    });
+}
 
-    std::vector<char> engine_data(fsize);
-    engine_file.read(engine_data.data(), fsize);
+void TRTSegmentation::inference_stats(LatencySummary out[kNumInferenceStages]) const {
+    for (int i = 0; i < kNumInferenceStages; ++i) {
+        out[i] = this->stats_.summary(static_cast<InferenceStage>(i));
+    }
+}
 
-    this->runtime_.reset(nvinfer1::createInferRuntime(this->logger_));
-    if (!this->runtime_) {
-        std::cerr << "Error: Failed to create TensorRT runtime." << std::endl;
+void TRTSegmentation::reset_inference_stats() {
+    this->stats_.reset();
+}
+
+int TRTSegmentation::enable_perf_counters(bool enable) {
+    if (!this->stats_.enable_perf_counters(enable)) {
+        std::cerr << "Error: Hardware performance counters are not available (check perf_event_paranoid)." << std::endl;
         return -1;
     }
+    return 0;
+}
 
-    this->engine_.reset(this->runtime_->deserializeCudaEngine(engine_data.data(), fsize));
-    if (!this->engine_) {
-        std::cerr << "Error: Failed to deserialize CUDA engine." << std::endl;
+void TRTSegmentation::perf_counters(PerfSummary out[kNumInferenceStages]) const {
+    for (int i = 0; i < kNumInferenceStages; ++i) {
+        out[i] = this->stats_.perf_summary(static_cast<InferenceStage>(i));
+    }
+}
+
+int TRTSegmentation::start_trace(size_t events_per_thread, const std::string& dump_on_destroy_path) {
+    if (events_per_thread == 0) {
         return -1;
     }
+    this->trace_dump_path_ = dump_on_destroy_path;
+    this->stats_.trace().enable(events_per_thread);
+    return 0;
+}
 
-    this->context_.reset(this->engine_->createExecutionContext());
-    if (!this->context_) {
-        std::cerr << "Error: Failed to create execution context." << std::endl;
+void TRTSegmentation::stop_trace() {
+    this->stats_.trace().disable();
+}
+
+int TRTSegmentation::dump_trace(const std::string& path) const {
+    return this->stats_.trace().dump(path) ? 0 : -1;
+}
+
+int TRTSegmentation::init(const std::string& model_path) {
+    std::unique_ptr<InferenceBackend> backend = create_backend(this->backend_kind_, model_path);
+    if (!backend) {
+        return -1;
+    }
+    return this->attach(std::move(backend));
+}
+
+int TRTSegmentation::init_from_memory(const void* model_data, size_t model_size) {
+    if (!model_data || model_size == 0) {
+        std::cerr << "Error: Empty engine data." << std::endl;
         return -1;
     }
 
-    // Get tensor names and indices, but defer buffer allocation to run()
-    for (int i = 0; i < this->engine_->getNbIOTensors(); ++i) {
-        const char* tensor_name = this->engine_->getIOTensorName(i);
-        if (this->engine_->getTensorIOMode(tensor_name) == nvinfer1::TensorIOMode::kINPUT) {
-            this->input_tensor_name_ = tensor_name;
-            this->input_binding_index_ = i;
-        } else {
-            this->output_tensor_name_ = tensor_name;
-            this->output_binding_index_ = i;
+    std::unique_ptr<InferenceBackend> backend = create_backend(this->backend_kind_, model_data, model_size);
+    if (!backend) {
+        return -1;
+    }
+    return this->attach(std::move(backend));
+}
+
+int TRTSegmentation::attach(std::unique_ptr<InferenceBackend> backend) {
+    // Release contexts created on a previously loaded model before dropping it
+    this->pipeline_.reset();
+    this->scheduler_.reset();
+    this->slots_.clear();
+    this->backend_ = std::move(backend);
+    // Buckets were checked against the previous model's input range
+    this->shape_buckets_.clear();
+
+    // One execution context per slot; all of them share the loaded model
+    for (int i = 0; i < this->num_contexts_; ++i) {
+        auto slot = std::make_unique<InferenceSlot>();
+        slot->context = this->backend_->create_context();
+        if (!slot->context) {
+            this->slots_.clear();
+            this->backend_.reset();
+            return -1;
+        }
+        slot->context->set_stats(&this->stats_);
+        this->slots_.add(std::move(slot));
+    }
+
+    this->max_engine_batch_ = std::max(this->backend_->max_batch_size(), 1);
+    return 0;
+}
+
+InputGeometry TRTSegmentation::input_geometry(const BatchJob& job) const {
+    if (job.fixed_input || this->shape_buckets_.empty()) {
+        return InputGeometry{kInputWidth, kInputHeight, kInputWidth, kInputHeight};
+    }
+    return letterbox_geometry(this->shape_buckets_, job.image->width, job.image->height);
+}
+
+void TRTSegmentation::preprocess(InferenceSlot& slot, const ImageView& image, float* dst, const InputGeometry& geometry) {
+    // Resize, normalize (mean/std) and HWC -> CHW in a single pass over the source pixels
+    slot.preprocess_engine.run(image, dst, geometry.input_width, geometry.input_height, geometry.content_width,
+                               geometry.content_height);
+}
+
+void TRTSegmentation::postprocess(const void* output, TensorDataType type, const OutputLayout& layout, BatchJob& job) {
+    if (job.packed) {
+        // Any non-zero byte becomes a set bit, so the foreground threshold is all the line needs
+        postprocess_rows(output, type, layout, PackedMaskRows{*job.packed}, ArgmaxOutput::kForegroundMask, job.components);
+        return;
+    }
+    if (job.mask->empty()) {
+        job.mask->create(layout.height, layout.width, CV_8UC1);
+    }
+    if (job.confidence) {
+        if (job.confidence->empty()) {
+            job.confidence->create(job.mask->rows, job.mask->cols, CV_8UC1);
+        }
+        postprocess_confidence_rows(output, type, layout, ConfidenceMaskRows{*job.mask, *job.confidence, layout.width}, job.mode,
+                                    job.components);
+        return;
+    }
+    postprocess_rows(output, type, layout, ByteMaskRows{*job.mask}, job.mode, job.components);
+}
+
+int TRTSegmentation::set_dynamic_batching(int max_batch_size, int max_delay_us) {
+    if (!this->backend_ || max_delay_us < 0) {
+        return -1;
+    }
+
+    this->scheduler_.reset();
+    const int batch = std::min(max_batch_size, this->max_engine_batch_);
+    if (batch <= 1) {
+        return 0; // batching disabled, run() executes each request on its own
+    }
+
+    this->scheduler_ = std::make_unique<BatchScheduler<BatchJob>>(
+        static_cast<size_t>(batch), std::chrono::microseconds(max_delay_us), static_cast<size_t>(this->num_contexts_),
+        [this](std::vector<BatchJob*>& jobs) {
+            const int status = this->infer_batch(jobs.data(), jobs.size());
+            for (BatchJob* job : jobs) job->status = status;
+        });
+    return 0;
+}
+
+int TRTSegmentation::set_tiling(bool enable, int overlap) {
+    if (overlap < 0 || overlap >= std::min(kInputWidth, kInputHeight)) {
+        return -1;
+    }
+    this->tiling_ = enable;
+    this->tile_overlap_ = overlap;
+    return 0;
+}
+
+int TRTSegmentation::set_shape_buckets(const std::vector<ShapeBucket>& buckets) {
+    if (!this->backend_) {
+        return -1;
+    }
+    for (const ShapeBucket& bucket : buckets) {
+        if (bucket.width <= 0 || bucket.height <= 0 || !this->backend_->accepts_input_size(bucket.height, bucket.width)) {
+            std::cerr << "Error: Input bucket " << bucket.width << "x" << bucket.height
+                      << " is outside the engine's input range." << std::endl;
+            return -1;
         }
     }
+    this->shape_buckets_ = buckets;
+    return 0;
+}
+
+int TRTSegmentation::set_polygon_epsilon(double epsilon) {
+    if (!(epsilon >= 0.0)) {
+        return -1;
+    }
+    this->polygon_epsilon_ = epsilon;
+    return 0;
+}
+
+std::unique_ptr<StreamSession> TRTSegmentation::open_stream(int width, PixelFormat format, int overlap, ArgmaxOutput mode) {
+    if (!this->backend_ || width <= 0 || overlap < 0 || overlap >= std::min(kInputWidth, kInputHeight)) {
+        std::cerr << "Error: Invalid stream parameters." << std::endl;
+        return nullptr;
+    }
+    return std::make_unique<StreamSession>(*this, width, format, overlap, mode);
+}
+
+int TRTSegmentation::start_pipeline(int queue_depth) {
+    if (!this->backend_ || queue_depth < 1) {
+        return -1;
+    }
+    this->pipeline_.reset();
+    this->pipeline_ = std::make_unique<SegmentationPipeline>(*this, static_cast<size_t>(queue_depth), default_io_threads());
+    return 0;
+}
+
+int TRTSegmentation::pipeline_submit(const std::string& image_path, const std::string& output_mask_path) {
+    if (!this->pipeline_) {
+        return -1;
+    }
+    this->pipeline_->submit(image_path, output_mask_path);
+    return 0;
+}
 
-    if (this->input_tensor_name_.empty() || this->output_tensor_name_.empty()) {
-        std::cerr << "Error: Could not find input or output tensors." << std::endl;
+int TRTSegmentation::pipeline_flush() {
+    if (!this->pipeline_) {
         return -1;
     }
+    return this->pipeline_->flush();
+}
 
+int TRTSegmentation::pipeline_stats(PipelineStageStats out[kNumPipelineStages], PipelineStageStats& io) const {
+    if (!this->pipeline_) {
+        return -1;
+    }
+    this->pipeline_->stats(out, io);
     return 0;
 }
 
-void TRTSegmentation::preprocess(const cv::Mat& image) {
-    cv::Mat float_image;
-    image.convertTo(float_image, CV_32FC3, 1.0 / 255.0);
+void TRTSegmentation::stop_pipeline() {
+    this->pipeline_.reset();
+}
 
-    // Normalization with mean and std
-    const float mean[3] = {0.485f, 0.456f, 0.406f};
-    const float std[3] = {0.229f, 0.224f, 0.225f};
+int TRTSegmentation::run_batch(const char* const* image_paths, const char* const* output_mask_paths, int count, int* statuses) {
+    if (!this->backend_ || count < 0 || (count > 0 && (!image_paths || !output_mask_paths))) {
+        return -1;
+    }
 
-    int height = image.rows;
-    int width = image.cols;
-    this->host_input_.resize(1 * 3 * height * width);
-    float* host_data_ptr = this->host_input_.data();
+    // A private pipeline, so batches do not mix with requests submitted through pipeline_submit
+    const size_t queue_depth = std::max<size_t>(4, 2 * static_cast<size_t>(this->num_contexts_));
+    SegmentationPipeline pipeline(*this, queue_depth, default_io_threads());
+    int skipped = 0;
+    for (int i = 0; i < count; ++i) {
+        if (statuses) statuses[i] = -1;
+        if (!image_paths[i] || !output_mask_paths[i]) {
+            ++skipped;
+            continue;
+        }
+        pipeline.submit(image_paths[i], output_mask_paths[i], [statuses, i](int status) {
+            if (statuses) statuses[i] = status;
+        });
+    }
+    return pipeline.flush() + skipped;
+}
+
+int TRTSegmentation::run_manifest(const std::string& manifest_path) {
+    std::ifstream manifest(manifest_path);
+    if (!manifest) {
+        std::cerr << "Error: Could not open manifest: " << manifest_path << std::endl;
+        return -1;
+    }
+
+    std::vector<std::string> inputs, outputs;
+    int malformed = 0;
+    std::string line;
+    for (int line_no = 1; std::getline(manifest, line); ++line_no) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (line.empty() || line[0] == '#') continue;
+
+        const size_t tab = line.find('\t');
+        if (tab == std::string::npos || tab == 0 || tab + 1 == line.size()) {
+            std::cerr << "Error: Malformed manifest line " << line_no << ": " << line << std::endl;
+            ++malformed;
+            continue;
+        }
+        inputs.push_back(line.substr(0, tab));
+        outputs.push_back(line.substr(tab + 1));
+    }
+
+    std::vector<const char*> input_ptrs, output_ptrs;
+    for (size_t i = 0; i < inputs.size(); ++i) {
+        input_ptrs.push_back(inputs[i].c_str());
+        output_ptrs.push_back(outputs[i].c_str());
+    }
+    const int failures = this->run_batch(input_ptrs.data(), output_ptrs.data(), static_cast<int>(inputs.size()), nullptr);
+    return failures < 0 ? failures : failures + malformed;
+}
+
+int TRTSegmentation::infer(const ImageView& image, ArgmaxOutput mode, cv::Mat& output_mask, ComponentSet* components) {
+    BatchJob job;
+    job.image = &image;
+    job.mode = mode;
+    job.mask = &output_mask;
+    job.components = components;
+    return this->infer(job);
+}
+
+int TRTSegmentation::infer(const ImageView& image, ArgmaxOutput mode, cv::Mat& output_mask, cv::Mat& confidence) {
+    BatchJob job;
+    job.image = &image;
+    job.mode = mode;
+    job.mask = &output_mask;
+    job.confidence = &confidence;
+    return this->infer(job);
+}
+
+int TRTSegmentation::infer(const ImageView& image, PackedMask& packed, ComponentSet* components) {
+    BatchJob job;
+    job.image = &image;
+    job.packed = &packed;
+    job.components = components;
+    return this->infer(job);
+}
+
+int TRTSegmentation::infer(BatchJob& job) {
+    job.request_id = TraceRequestScope::current();
+    if (this->scheduler_) {
+        // Coalesced with other concurrent requests; blocks until our batch has run
+        this->scheduler_->run(job);
+        return job.status;
+    }
+
+    BatchJob* jobs[1] = {&job};
+    return this->infer_batch(jobs, 1);
+}
 
-    for (int c = 0; c < 3; ++c) {
-        for (int h = 0; h < height; ++h) {
-            for (int w = 0; w < width; ++w) {
-                // Assuming BGR input from cv::imread, normalize and convert to CHW
-                float val = float_image.at<cv::Vec3f>(h, w)[c];
-                host_data_ptr[c * (height * width) + h * width + w] = (val - mean[c]) / std[c];
+int TRTSegmentation::infer_batch(BatchJob* const* jobs, size_t count, InferenceSlot* slot) {
+    if (!this->shape_buckets_.empty() && count > 1) {
+        // Coalesced requests may have picked different buckets; each input size is its own engine call
+        auto bucket_key = [this](const BatchJob* job) {
+            const InputGeometry geometry = this->input_geometry(*job);
+            return std::make_pair(geometry.input_height, geometry.input_width);
+        };
+        std::vector<BatchJob*> sorted(jobs, jobs + count);
+        std::stable_sort(sorted.begin(), sorted.end(),
+                         [&](const BatchJob* a, const BatchJob* b) { return bucket_key(a) < bucket_key(b); });
+        if (bucket_key(sorted.front()) != bucket_key(sorted.back())) {
+            int status = 0;
+            for (size_t first = 0; first < count;) {
+                size_t last = first + 1;
+                while (last < count && bucket_key(sorted[last]) == bucket_key(sorted[first])) ++last;
+                if (this->infer_batch(sorted.data() + first, last - first, slot) != 0) status = -1;
+                first = last;
             }
+            return status;
         }
     }
+
+    // 从池中取得一个空闲的执行上下文 (调用方已持有时直接使用)，函数返回时自动归还
+    ResourcePool<InferenceSlot>::Lease lease;
+    if (!slot) {
+        lease = this->slots_.acquire();
+        slot = lease.get();
+    }
+    // Spans covering the whole batch belong to a request only when the batch has one
+    TraceRequestScope request(count == 1 ? jobs[0]->request_id : 0);
+    if (this->prepare(*slot, jobs, count) != 0 || this->execute(*slot) != 0) {
+        return -1;
+    }
+    return this->finish(*slot, jobs, count);
 }
 
-void TRTSegmentation::postprocess(cv::Mat& mask, const nvinfer1::Dims& dims) {
-    int num_classes = dims.d[1];
-    int height = dims.d[2];
-    int width = dims.d[3];
-    
-    mask = cv::Mat(height, width, CV_8UC1);
-    
-    for (int h = 0; h < height; ++h) {
-        for (int w = 0; w < width; ++w) {
-            float max_val = -std::numeric_limits<float>::infinity();
-            int max_idx = 0;
-            for (int c = 0; c < num_classes; ++c) {
-                // Note: The model output might be int64 or float32 depending on the model.
-                // Casting to float here for general case.
-                float val = static_cast<float>(this->host_output_[c * (height * width) + h * width + w]);
-                if (val > max_val) {
-                    max_val = val;
-                    max_idx = c;
-                }
+int TRTSegmentation::prepare(InferenceSlot& slot, BatchJob* const* jobs, size_t count) {
+    // 1. 确定每张图像在输入中的位置；批次中的图像共享同一个输入尺寸 (infer_batch 已按尺寸分组)
+    for (size_t i = 0; i < count; ++i) {
+        jobs[i]->geometry = this->input_geometry(*jobs[i]);
+    }
+    const int target_height = jobs[0]->geometry.input_height;
+    const int target_width = jobs[0]->geometry.input_width;
+    const int batch = static_cast<int>(count);
+
+    // 2. 设置输入维度，顺序为 (N, C, H, W)，即 (批量, 通道, 高度, 宽度)；后端据此准备缓冲区
+    slot.input_shape = {batch, 3, target_height, target_width};
+    if (!slot.context->set_input_shape(slot.input_shape)) {
+        return -1;
+    }
+
+    // 3. 缩放与归一化在 preprocess 中一次完成，每张图像写入批次中自己的位置
+    float* input = slot.context->input();
+    const size_t input_stride = shape_volume(slot.input_shape) / count;
+    for (size_t i = 0; i < count; ++i) {
+        TraceRequestScope request(jobs[i]->request_id);
+        ScopedStageTimer timer(&this->stats_, kStageTimePreprocess);
+        this->preprocess(slot, *jobs[i]->image, input + i * input_stride, jobs[i]->geometry);
+    }
+    return 0;
+}
+
+int TRTSegmentation::execute(InferenceSlot& slot) {
+    return slot.context->execute() ? 0 : -1;
+}
+
+int TRTSegmentation::finish(const InferenceSlot& slot, BatchJob* const* jobs, size_t count) {
+    const TensorShape output_shape = slot.context->output_shape();
+    const TensorDataType output_type = slot.context->output_type();
+    OutputLayout layout;
+    if (!output_layout(output_shape, output_type, layout)) {
+        std::cerr << "Error: Expected NCHW class scores or an NHW label map as model output." << std::endl;
+        return -1;
+    }
+    // Label output is one byte per pixel; with more classes the winning index would not fit
+    if (!is_label_map(output_type) && layout.num_classes > 256) {
+        for (size_t i = 0; i < count; ++i) {
+            if (jobs[i]->mode == ArgmaxOutput::kLabels) {
+                std::cerr << "Error: Label output supports at most 256 classes, the model has " << layout.num_classes
+                          << "." << std::endl;
+                return -1;
             }
-            mask.at<uchar>(h, w) = (max_idx > 0) ? 255 : 0;
         }
     }
+
+    // 把批次输出分发回每个请求；按输出的实际类型计算偏移，不做任何类型转换
+    const uint8_t* output = static_cast<const uint8_t*>(slot.context->output());
+    const size_t elements = shape_volume(output_shape) / count;
+    const size_t output_stride = elements * data_type_size(output_type);
+    std::vector<float> converted;
+    for (size_t i = 0; i < count; ++i) {
+        TraceRequestScope request(jobs[i]->request_id);
+        ScopedStageTimer timer(&this->stats_, kStageTimePostprocess);
+        const void* image_output = output + i * output_stride;
+        if (!jobs[i]->sink) {
+            this->postprocess(image_output, output_type, content_layout(layout, jobs[i]->geometry), *jobs[i]);
+        } else if (output_type == TensorDataType::kFloat32) {
+            jobs[i]->sink(static_cast<const float*>(image_output), output_shape);
+        } else if (output_type == TensorDataType::kFloat16) {
+            // Stitching accumulates in float, so fp16 tiles are widened once here
+            converted.resize(elements);
+            half_to_float(static_cast<const uint16_t*>(image_output), converted.data(), elements);
+            jobs[i]->sink(converted.data(), output_shape);
+        } else {
+            std::cerr << "Error: Tiling needs class scores; label map outputs cannot be blended." << std::endl;
+            return -1;
+        }
+    }
+    return 0;
+}
+
+bool TRTSegmentation::use_tiling(const ImageView& image) const {
+    return this->tiling_ && (image.width > kInputWidth || image.height > kInputHeight);
+}
+
+int TRTSegmentation::infer_tiled(const ImageView& image, ArgmaxOutput mode, cv::Mat& mask, ComponentSet* components,
+                                 InferenceSlot* slot) {
+    const std::vector<int> xs = tile_positions(image.width, kInputWidth, this->tile_overlap_);
+    const std::vector<int> ys = tile_positions(image.height, kInputHeight, this->tile_overlap_);
+    const cv::Mat source(image.height, image.width, CV_8UC(pixel_format_channels(image.format)),
+                         const_cast<uint8_t*>(image.data), image.stride);
+
+    // One row of tiles at a time, so only kInputHeight rows of logits are ever accumulated
+    TileStitcher stitcher(image.width, image.height, kInputWidth, kInputHeight, this->tile_overlap_);
+    // Emitted rows are labelled in order, right after their argmax
+    std::unique_ptr<ComponentLabeller> labeller;
+    ComponentLabeller::Chunk* chunk = nullptr;
+    if (components) {
+        labeller = std::make_unique<ComponentLabeller>(ColumnGrid::identity(image.width));
+        chunk = labeller->begin_chunk(0);
+    }
+    for (size_t row = 0; row < ys.size(); ++row) {
+        const int y = ys[row];
+        const cv::Mat band = source.rowRange(y, std::min(y + kInputHeight, image.height));
+        if (this->infer_tile_row(band, image.format, xs, y, mode, stitcher, slot) != 0) {
+            return -1;
+        }
+
+        // Rows above the next tile row will not receive any more contributions
+        ScopedStageTimer timer(&this->stats_, kStageTimePostprocess);
+        const int begin = static_cast<int>(stitcher.emitted_rows());
+        stitcher.emit(row + 1 < ys.size() ? ys[row + 1] : image.height, mask.ptr(begin), mask.step, mode);
+        for (int r = begin; chunk && r < stitcher.emitted_rows(); ++r) chunk->add_row(mask.ptr(r), r, r + 1);
+    }
+    if (labeller) labeller->finish(components->min_area, components->items);
+    return 0;
+}
+
+int TRTSegmentation::infer_tile_row(const cv::Mat& band, PixelFormat format, const std::vector<int>& xs, int64_t y,
+                                    ArgmaxOutput mode, TileStitcher& stitcher, InferenceSlot* slot) {
+    const uint64_t request_id = TraceRequestScope::current();
+    std::mutex stitch_mutex;
+
+    const size_t count = xs.size();
+    std::vector<cv::Mat> pixels(count);
+    std::vector<ImageView> views(count);
+    std::vector<BatchJob> jobs(count);
+    for (size_t i = 0; i < count; ++i) {
+        const int x = xs[i];
+        const cv::Rect rect(x, 0, std::min(kInputWidth, band.cols - x), band.rows);
+        if (rect.width < kInputWidth || rect.height < kInputHeight) {
+            // Only happens when the image is smaller than the tile along one axis, or at the end of a stream
+            cv::copyMakeBorder(band(rect), pixels[i], 0, kInputHeight - rect.height, 0, kInputWidth - rect.width,
+                               cv::BORDER_REPLICATE);
+        } else {
+            pixels[i] = band(rect);
+        }
+        views[i].data = pixels[i].data;
+        views[i].width = kInputWidth;
+        views[i].height = kInputHeight;
+        views[i].stride = pixels[i].step;
+        views[i].format = format;
+
+        jobs[i].image = &views[i];
+        jobs[i].mode = mode;
+        jobs[i].fixed_input = true;
+        jobs[i].request_id = request_id;
+        jobs[i].sink = [&stitcher, &stitch_mutex, x, y](const float* logits, const TensorShape& shape) {
+            std::lock_guard<std::mutex> lock(stitch_mutex);
+            stitcher.add(x, y, logits, shape);
+        };
+    }
+
+    // Engine-sized batches of tiles, spread over the execution contexts, or run one after another
+    // on the caller's context when it already holds one
+    const size_t batch = std::min(static_cast<size_t>(this->max_engine_batch_), count);
+    const int num_batches = static_cast<int>((count + batch - 1) / batch);
+    std::atomic<int> failures{0};
+    cv::parallel_for_(cv::Range(0, num_batches), [&](const cv::Range& range) {
+        for (int b = range.start; b < range.end; ++b) {
+            const size_t first = static_cast<size_t>(b) * batch;
+            const size_t n = std::min(batch, count - first);
+            std::vector<BatchJob*> batch_jobs;
+            for (size_t i = first; i < first + n; ++i) batch_jobs.push_back(&jobs[i]);
+            if (this->infer_batch(batch_jobs.data(), n, slot) != 0) ++failures;
+        }
+    }, slot ? 1 : this->num_contexts_);
+    return failures.load() == 0 ? 0 : -1;
 }
 
 int TRTSegmentation::run(const std::string& image_path, const std::string& output_mask_path) {
-    cv::Mat image = cv::imread(image_path, cv::IMREAD_COLOR);
-    if (image.empty()) {
+    return this->run(image_path, output_mask_path, mask_format_for_path(output_mask_path));
+}
+
+int TRTSegmentation::run(const std::string& image_path, const std::string& output_mask_path, MaskFormat format,
+                         ComponentSet* components) {
+    TraceRequestScope request(this->stats_.next_request_id());
+    ScopedStageTimer total(&this->stats_, kStageTimeTotal);
+
+    ScopedStageTimer decode(&this->stats_, kStageTimeDecode);
+    DecodedImage image;
+    if (this->decode_file(image_path, image) != 0) {
         std::cerr << "Error: Could not read input image: " << image_path << std::endl;
         return -1;
     }
+    decode.stop();
+    return this->run_decoded(image, output_mask_path, format, components);
+}
 
-    const int original_height = image.rows;
-    const int original_width = image.cols;
+int TRTSegmentation::run_encoded(const void* data, size_t size, const std::string& output_mask_path, MaskFormat format) {
+    TraceRequestScope request(this->stats_.next_request_id());
+    ScopedStageTimer total(&this->stats_, kStageTimeTotal);
 
-    // --- 修改开始 ---
+    ScopedStageTimer decode(&this->stats_, kStageTimeDecode);
+    DecodedImage image;
+    if (data && size > 0) {
+        this->decode(static_cast<const uint8_t*>(data), size, image);
+    }
+    if (image.pixels.empty()) {
+        std::cerr << "Error: Could not decode input image from memory." << std::endl;
+        return -1;
+    }
+    decode.stop();
+    return this->run_decoded(image, output_mask_path, format, nullptr);
+}
 
-    // 1. 定义明确的目标高度和宽度
-    const int target_height = 256;
-    const int target_width = 2048;
+void TRTSegmentation::decode_target(int width, int height, int& min_width, int& min_height) const {
+    if (this->tiling_ && (width > kInputWidth || height > kInputHeight)) {
+        // Tiles are cut from the original pixels
+        min_width = width;
+        min_height = height;
+    } else if (this->shape_buckets_.empty()) {
+        min_width = kInputWidth;
+        min_height = kInputHeight;
+    } else {
+        const InputGeometry geometry = letterbox_geometry(this->shape_buckets_, width, height);
+        min_width = geometry.content_width;
+        min_height = geometry.content_height;
+    }
+}
 
-    cv::Mat resized_image;
-    // 2. 调用 cv::resize 时，cv::Size 的参数顺序为 (宽度, 高度)
-    cv::resize(image, resized_image, cv::Size(target_width, target_height));
+void TRTSegmentation::decode(const uint8_t* data, size_t size, DecodedImage& image) const {
+    int denominator = 1;
+    int width = 0, height = 0;
+    if (jpeg_dimensions(data, size, width, height)) {
+        // The EXIF orientation is only known after decoding, so the scale must suffice either way round
+        int min_width = 0, min_height = 0;
+        this->decode_target(width, height, min_width, min_height);
+        denominator = reduced_decode_denominator(width, height, min_width, min_height);
+        this->decode_target(height, width, min_width, min_height);
+        denominator = std::min(denominator, reduced_decode_denominator(height, width, min_width, min_height));
+    }
+    decode_image(data, size, denominator, image);
+}
 
-    // 3. 设置 TensorRT 的输入维度，顺序为 (N, C, H, W)，即 (批量, 通道, 高度, 宽度)
-    if (!this->context_->setInputShape(this->input_tensor_name_.c_str(), nvinfer1::Dims4{1, 3, target_height, target_width})) {
-        std::cerr << "Error: Failed to set input shape." << std::endl;
+int TRTSegmentation::decode_file(const std::string& path, DecodedImage& image) const {
+    // Read into a buffer rather than mapped: inputs may still be growing (e.g. written by a camera
+    // process), and a mapping of a file truncated mid-decode raises SIGBUS instead of failing
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file) {
+        return -1;
+    }
+    const std::streamoff size = file.tellg();
+    if (size <= 0) {
         return -1;
     }
+    std::vector<uint8_t> data(static_cast<size_t>(size));
+    file.seekg(0);
+    if (!file.read(reinterpret_cast<char*>(data.data()), size)) {
+        return -1;
+    }
+    this->decode(data.data(), data.size(), image);
+    return image.pixels.empty() ? -1 : 0;
+}
+
+int TRTSegmentation::run_decoded(const DecodedImage& image, const std::string& output_mask_path, MaskFormat format,
+                                 ComponentSet* components) {
+    ImageView view;
+    view.data = image.pixels.data;
+    view.width = image.pixels.cols;
+    view.height = image.pixels.rows;
+    view.stride = image.pixels.step;
+    view.format = PixelFormat::kBGR;
 
-    // Allocate/Reallocate buffers now that we have the exact dimensions
-    for (void* buffer : buffers_) { // Free any previous allocations
-        cudaFree(buffer);
+    if (is_polygon_format(format)) {
+        if (components) {
+            std::cerr << "Error: Component statistics need a raster mask output." << std::endl;
+            return -1;
+        }
+        std::vector<PolygonRing> rings;
+        if (this->infer_polygons(view, ArgmaxOutput::kForegroundMask, this->polygon_epsilon_, image.width, image.height,
+                                 rings) != 0) {
+            return -1;
+        }
+        ScopedStageTimer encode(&this->stats_, kStageTimeEncode);
+        return write_polygons(output_mask_path, format == MaskFormat::kPolygonJson, rings, image.width, image.height);
+    }
+
+    if (format != MaskFormat::kPng) {
+        // Postprocess packs the full-resolution bits directly; there is no byte mask to compress
+        PackedMask packed;
+        packed.create(image.width, image.height);
+        if (this->infer_packed(view, packed, components) != 0) {
+            return -1;
+        }
+        ScopedStageTimer encode(&this->stats_, kStageTimeEncode);
+        return write_packed_mask(output_mask_path, format, packed);
+    }
+
+    // Allocated at the original size, so postprocess writes the full-resolution mask directly
+    // (also when the image was decoded at a reduced size)
+    cv::Mat final_mask(image.height, image.width, CV_8UC1);
+    const int status = this->use_tiling(view) ? this->infer_tiled(view, ArgmaxOutput::kForegroundMask, final_mask, components)
+                                              : this->infer(view, ArgmaxOutput::kForegroundMask, final_mask, components);
+    if (status != 0) {
+        return -1;
     }
-    buffers_.assign(this->engine_->getNbIOTensors(), nullptr);
 
-    for (int i = 0; i < this->engine_->getNbIOTensors(); ++i) {
-        const char* tensor_name = this->engine_->getIOTensorName(i);
-        nvinfer1::Dims dims = this->context_->getTensorShape(tensor_name);
-        size_t vol = 1;
-        for (int j = 0; j < dims.nbDims; ++j) vol *= dims.d[j];
-        cudaMalloc(&this->buffers_[i], vol * sizeof(float)); // Assuming float for both
+    ScopedStageTimer encode(&this->stats_, kStageTimeEncode);
+    if (!cv::imwrite(output_mask_path, final_mask)) {
+        std::cerr << "Error: Could not save output mask." << std::endl;
+        return -1;
     }
 
-    this->preprocess(resized_image);
+    return 0;
+}
 
-    cudaMemcpy(this->buffers_[this->input_binding_index_], this->host_input_.data(), this->host_input_.size() * sizeof(float), cudaMemcpyHostToDevice);
+int TRTSegmentation::infer_packed(const ImageView& image, PackedMask& packed, ComponentSet* components,
+                                  InferenceSlot* slot) {
+    if (packed.empty()) {
+        packed.create(image.width, image.height);
+    }
+    if (!this->use_tiling(image)) {
+        return this->infer(image, packed, components);
+    }
+    // The stitcher emits byte rows, so tiled images are packed afterwards
+    cv::Mat mask(image.height, image.width, CV_8UC1);
+    if (this->infer_tiled(image, ArgmaxOutput::kForegroundMask, mask, components, slot) != 0) {
+        return -1;
+    }
+    pack_mask(mask.data, mask.step, mask.cols, mask.rows, packed);
+    return 0;
+}
 
-    if (!this->context_->executeV2(this->buffers_.data())) {
-        std::cerr << "Error: Failed to execute inference." << std::endl;
+int TRTSegmentation::infer_polygons(const ImageView& image, ArgmaxOutput mode, double epsilon, int width, int height,
+                                    std::vector<PolygonRing>& rings) {
+    cv::Mat mask;
+    if (this->use_tiling(image)) {
+        // Tiles are stitched at the original resolution; there is no smaller map to trace
+        mask.create(image.height, image.width, CV_8UC1);
+        if (this->infer_tiled(image, mode, mask) != 0) {
+            return -1;
+        }
+    } else if (this->infer(image, mode, mask) != 0) { // empty: stays at the model's output resolution
         return -1;
     }
+    ScopedStageTimer timer(&this->stats_, kStageTimePostprocess);
+    trace_polygons(mask, epsilon, width, height, rings);
+    return 0;
+}
 
-    auto output_dims = this->context_->getTensorShape(this->output_tensor_name_.c_str());
-    size_t output_size = 1;
-    for(int j=0; j < output_dims.nbDims; ++j) output_size *= output_dims.d[j];
-    
-    // The model output might be int64, let's assume float for now as per buffer allocation
-    // but be mindful of the actual model output type.
-    host_output_.resize(output_size);
-    cudaMemcpy(this->host_output_.data(), this->buffers_[this->output_binding_index_], output_size * sizeof(float), cudaMemcpyDeviceToHost);
+int TRTSegmentation::run_buffer(const ImageView& image, ArgmaxOutput mode, uint8_t* mask_out, size_t mask_stride,
+                                ComponentSet* components) {
+    TraceRequestScope request(this->stats_.next_request_id());
+    ScopedStageTimer total(&this->stats_, kStageTimeTotal);
 
-    cv::Mat output_mask;
-    this->postprocess(output_mask, output_dims);
+    // Wrap the caller's buffer; postprocess upscales straight into it
+    cv::Mat final_mask(image.height, image.width, CV_8UC1, mask_out, mask_stride);
+    if (this->use_tiling(image)) {
+        return this->infer_tiled(image, mode, final_mask, components);
+    }
+    return this->infer(image, mode, final_mask, components);
+}
 
-    cv::Mat final_mask;
-    cv::resize(output_mask, final_mask, cv::Size(original_width, original_height), 0, 0, cv::INTER_NEAREST);
+int TRTSegmentation::run_buffer_lowres(const ImageView& image, ArgmaxOutput mode, uint8_t* mask_out, size_t capacity,
+                                       int& mask_width, int& mask_height) {
+    TraceRequestScope request(this->stats_.next_request_id());
+    ScopedStageTimer total(&this->stats_, kStageTimeTotal);
 
-    if (!cv::imwrite(output_mask_path, final_mask)) {
-        std::cerr << "Error: Could not save output mask." << std::endl;
+    cv::Mat output_mask; // empty: postprocess allocates it at the model's output resolution
+    if (this->infer(image, mode, output_mask) != 0) {
+        return -1;
+    }
+    mask_width = output_mask.cols;
+    mask_height = output_mask.rows;
+    if (output_mask.total() > capacity) {
+        std::cerr << "Error: Mask buffer too small for " << mask_width << "x" << mask_height << std::endl;
         return -1;
     }
+    for (int y = 0; y < mask_height; ++y) {
+        std::memcpy(mask_out + static_cast<size_t>(y) * mask_width, output_mask.ptr(y), static_cast<size_t>(mask_width));
+    }
+    return 0;
+}
+
+int TRTSegmentation::run_buffer_packed(const ImageView& image, uint8_t* bits_out, size_t bits_stride) {
+    TraceRequestScope request(this->stats_.next_request_id());
+    ScopedStageTimer total(&this->stats_, kStageTimeTotal);
 
+    PackedMask packed;
+    if (bits_stride < (static_cast<size_t>(image.width) + 7) / 8 || this->infer_packed(image, packed) != 0) {
+        return -1;
+    }
+    for (int y = 0; y < packed.height; ++y) {
+        std::memcpy(bits_out + static_cast<size_t>(y) * bits_stride, packed.row(y), packed.stride);
+    }
     return 0;
 }
+
+int TRTSegmentation::run_buffer_polygons(const ImageView& image, ArgmaxOutput mode, double epsilon,
+                                         std::vector<PolygonRing>& rings) {
+    TraceRequestScope request(this->stats_.next_request_id());
+    ScopedStageTimer total(&this->stats_, kStageTimeTotal);
+    return this->infer_polygons(image, mode, epsilon, image.width, image.height, rings);
+}
+
+int TRTSegmentation::run_buffer_confidence(const ImageView& image, ArgmaxOutput mode, uint8_t* mask_out, size_t mask_stride,
+                                           void* confidence_out, size_t confidence_stride, bool half) {
+    TraceRequestScope request(this->stats_.next_request_id());
+    ScopedStageTimer total(&this->stats_, kStageTimeTotal);
+
+    if (this->use_tiling(image)) {
+        // Blended tiles hold weighted logit sums, which are not on the softmax scale
+        std::cerr << "Error: Confidence output is not available with tiling." << std::endl;
+        return -1;
+    }
+    cv::Mat final_mask(image.height, image.width, CV_8UC1, mask_out, mask_stride);
+    cv::Mat confidence(image.height, image.width, half ? CV_16UC1 : CV_8UC1, confidence_out, confidence_stride);
+    return this->infer(image, mode, final_mask, confidence);
+}
@@ -0,0 +1,149 @@
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "batch_scheduler.h"
+
+// BatchScheduler 的单元测试：用 CPU 上的替身执行器代替推理后端，
+// 验证批次凑满立即执行、未凑满时在 max_delay 到期后执行、结果写回各自的调用方，以及析构时排空队列。
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+using std::chrono::milliseconds;
+
+struct Job {
+    int input = 0;
+    int output = -1;
+};
+
+// 记录每个批次的大小，并把 input * 10 写回每个任务
+struct StandInExecutor {
+    std::mutex mutex;
+    std::vector<size_t> batch_sizes;
+    std::atomic<int> executed{0};
+
+    void operator()(std::vector<Job*>& batch) {
+        for (Job* job : batch) job->output = job->input * 10;
+        this->executed += static_cast<int>(batch.size());
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->batch_sizes.push_back(batch.size());
+    }
+};
+
+int failures = 0;
+
+void check(bool condition, const char* test, const char* what) {
+    if (!condition) {
+        std::cerr << "FAIL " << test << ": " << what << std::endl;
+        ++failures;
+    }
+}
+
+long long elapsed_ms(Clock::time_point start) {
+    return std::chrono::duration_cast<milliseconds>(Clock::now() - start).count();
+}
+
+void full_batch_dispatches_immediately() {
+    const char* name = "full_batch_dispatches_immediately";
+    StandInExecutor executor;
+    // The delay is far longer than the test may take, so only a full batch can explain a dispatch
+    BatchScheduler<Job> scheduler(4, std::chrono::seconds(30), 1, std::ref(executor));
+
+    const Clock::time_point start = Clock::now();
+    std::vector<Job> jobs(4);
+    std::vector<std::thread> callers;
+    for (size_t i = 0; i < jobs.size(); ++i) {
+        jobs[i].input = static_cast<int>(i);
+        callers.emplace_back([&scheduler, &jobs, i] { scheduler.run(jobs[i]); });
+    }
+    for (auto& caller : callers) caller.join();
+
+    check(elapsed_ms(start) < 5000, name, "batch waited for max_delay");
+    check(executor.batch_sizes.size() == 1 && executor.batch_sizes[0] == 4, name, "expected a single batch of 4");
+}
+
+void partial_batch_dispatches_at_max_delay() {
+    const char* name = "partial_batch_dispatches_at_max_delay";
+    StandInExecutor executor;
+    const milliseconds delay(100);
+    BatchScheduler<Job> scheduler(8, delay, 1, std::ref(executor));
+
+    Job job;
+    job.input = 7;
+    const Clock::time_point start = Clock::now();
+    scheduler.run(job);
+    const long long waited = elapsed_ms(start);
+
+    check(waited >= delay.count(), name, "dispatched before max_delay");
+    check(waited < delay.count() + 5000, name, "dispatched long after max_delay");
+    check(executor.batch_sizes.size() == 1 && executor.batch_sizes[0] == 1, name, "expected a single batch of 1");
+    check(job.output == 70, name, "result not written back");
+}
+
+void results_return_to_their_callers() {
+    const char* name = "results_return_to_their_callers";
+    StandInExecutor executor;
+    BatchScheduler<Job> scheduler(4, milliseconds(2), 2, std::ref(executor));
+
+    std::vector<Job> jobs(64);
+    std::vector<std::thread> callers;
+    for (size_t i = 0; i < jobs.size(); ++i) {
+        jobs[i].input = static_cast<int>(i) + 1;
+        callers.emplace_back([&scheduler, &jobs, i] { scheduler.run(jobs[i]); });
+    }
+    for (auto& caller : callers) caller.join();
+
+    bool all_match = true;
+    for (const Job& job : jobs) all_match = all_match && job.output == job.input * 10;
+    check(all_match, name, "a caller received another caller's result");
+    check(executor.executed == static_cast<int>(jobs.size()), name, "jobs executed more or less than once");
+
+    bool within_limit = true;
+    for (size_t size : executor.batch_sizes) within_limit = within_limit && size >= 1 && size <= 4;
+    check(within_limit, name, "batch size outside [1, max_batch_size]");
+}
+
+void destructor_drains_queue() {
+    const char* name = "destructor_drains_queue";
+    StandInExecutor executor;
+    auto scheduler = std::make_unique<BatchScheduler<Job>>(4, std::chrono::seconds(30), 1, std::ref(executor));
+
+    std::vector<Job> jobs(2);
+    std::vector<std::thread> callers;
+    for (size_t i = 0; i < jobs.size(); ++i) {
+        jobs[i].input = static_cast<int>(i) + 1;
+        callers.emplace_back([s = scheduler.get(), &jobs, i] { s->run(jobs[i]); });
+    }
+    // Let both callers enqueue; the batch is neither full nor due
+    std::this_thread::sleep_for(milliseconds(200));
+    check(executor.executed == 0, name, "partial batch dispatched before max_delay");
+
+    const Clock::time_point start = Clock::now();
+    scheduler.reset();
+    for (auto& caller : callers) caller.join();
+
+    check(elapsed_ms(start) < 5000, name, "destructor waited for max_delay");
+    check(executor.executed == 2, name, "queued jobs were not executed");
+    check(jobs[0].output == 10 && jobs[1].output == 20, name, "results not written back");
+}
+
+} // namespace
+
+int main() {
+    full_batch_dispatches_immediately();
+    partial_batch_dispatches_at_max_delay();
+    results_return_to_their_callers();
+    destructor_drains_queue();
+
+    if (failures > 0) {
+        std::cerr << failures << " check(s) failed" << std::endl;
+        return 1;
+    }
+    std::cout << "batch_scheduler_test: all checks passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,137 @@
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+#include "buffer_pool.h"
+
+// BufferPool 的单元测试：用 HostAllocator 代替 CUDA 分配器，
+// 验证复用、增长、按张量名区分以及统计计数器。
+
+namespace {
+
+// 转发给 HostAllocator，并记录每次分配的字节数和尚未释放的缓冲区数
+class CountingAllocator : public IAllocator {
+public:
+    void* allocate(size_t bytes) override {
+        this->requests.push_back(bytes);
+        ++this->live;
+        return this->host_.allocate(bytes);
+    }
+    void deallocate(void* ptr) override {
+        --this->live;
+        this->host_.deallocate(ptr);
+    }
+
+    std::vector<size_t> requests;
+    int live = 0;
+
+private:
+    HostAllocator host_;
+};
+
+int failures = 0;
+
+void check(bool condition, const char* test, const char* what) {
+    if (!condition) {
+        std::cerr << "FAIL " << test << ": " << what << std::endl;
+        ++failures;
+    }
+}
+
+void reuses_when_capacity_suffices() {
+    const char* name = "reuses_when_capacity_suffices";
+    CountingAllocator allocator;
+    BufferPool pool(allocator);
+
+    void* first = pool.acquire("input", {1, 3, 64, 64}, TensorDataType::kFloat32);
+    void* same = pool.acquire("input", {1, 3, 64, 64}, TensorDataType::kFloat32);
+    // Smaller shape and a different type still fit: the pool is keyed by name only
+    void* smaller = pool.acquire("input", {1, 3, 32, 32}, TensorDataType::kFloat16);
+
+    check(first != nullptr, name, "allocation failed");
+    check(same == first && smaller == first, name, "buffer not reused");
+    check(reinterpret_cast<uintptr_t>(first) % 64 == 0, name, "host buffer not 64-byte aligned");
+
+    const BufferPoolStats s = pool.stats();
+    check(s.allocations == 1 && allocator.requests.size() == 1, name, "expected a single allocation");
+    check(s.reuses == 2, name, "expected two reuses");
+    check(s.reserved_bytes == 3 * 64 * 64 * 4, name, "reserved_bytes");
+    check(s.peak_request_bytes == 3 * 64 * 64 * 4, name, "peak_request_bytes");
+}
+
+void grows_for_larger_requests() {
+    const char* name = "grows_for_larger_requests";
+    CountingAllocator allocator;
+    BufferPool pool(allocator);
+
+    const size_t small = 1 * 1 * 16 * 16 * 4;
+    const size_t large = 2 * 1 * 16 * 16 * 4;
+    void* first = pool.acquire("output", {1, 1, 16, 16}, TensorDataType::kFloat32);
+    void* grown = pool.acquire("output", {2, 1, 16, 16}, TensorDataType::kFloat32);
+    void* again = pool.acquire("output", {1, 1, 16, 16}, TensorDataType::kFloat32);
+
+    check(first != nullptr && grown != nullptr, name, "allocation failed");
+    check(again == grown, name, "pool shrank after a smaller request");
+    check(allocator.live == 1, name, "old buffer not released on growth");
+    check(allocator.requests.size() == 2 && allocator.requests[0] == small && allocator.requests[1] == large, name,
+          "unexpected allocation sizes");
+
+    const BufferPoolStats s = pool.stats();
+    check(s.allocations == 2 && s.reuses == 1, name, "allocations/reuses");
+    check(s.reserved_bytes == large, name, "reserved_bytes should hold only the grown buffer");
+    // The old buffer is freed before the new one is allocated
+    check(s.peak_reserved_bytes == large, name, "peak_reserved_bytes");
+    check(s.peak_request_bytes == large, name, "peak_request_bytes");
+}
+
+void separate_tensors_and_release() {
+    const char* name = "separate_tensors_and_release";
+    CountingAllocator allocator;
+    BufferPool pool(allocator);
+
+    void* input = pool.acquire("input", {1, 3, 8, 8}, TensorDataType::kFloat32);
+    void* output = pool.acquire("output", {1, 2, 8, 8}, TensorDataType::kUint8);
+    check(input != nullptr && output != nullptr && input != output, name, "tensors share a buffer");
+
+    const size_t total = 3 * 8 * 8 * 4 + 2 * 8 * 8;
+    BufferPoolStats s = pool.stats();
+    check(s.allocations == 2 && s.reuses == 0, name, "allocations/reuses");
+    check(s.reserved_bytes == total && s.peak_reserved_bytes == total, name, "reserved/peak bytes");
+
+    pool.release_all();
+    s = pool.stats();
+    check(allocator.live == 0, name, "release_all leaked a buffer");
+    check(s.reserved_bytes == 0, name, "reserved_bytes not reset");
+    check(s.allocations == 2 && s.peak_reserved_bytes == total, name, "counters must survive release_all");
+
+    // Released entries are allocated again on the next request
+    pool.acquire("input", {1, 3, 8, 8}, TensorDataType::kFloat32);
+    check(pool.stats().allocations == 3, name, "no allocation after release_all");
+}
+
+void destructor_releases_buffers() {
+    const char* name = "destructor_releases_buffers";
+    CountingAllocator allocator;
+    {
+        BufferPool pool(allocator);
+        pool.acquire("input", {4}, TensorDataType::kInt64);
+        pool.acquire("output", {4}, TensorDataType::kInt32);
+    }
+    check(allocator.live == 0, name, "buffers leaked");
+}
+
+} // namespace
+
+int main() {
+    reuses_when_capacity_suffices();
+    grows_for_larger_requests();
+    separate_tensors_and_release();
+    destructor_releases_buffers();
+
+    if (failures > 0) {
+        std::cerr << failures << " check(s) failed" << std::endl;
+        return 1;
+    }
+    std::cout << "buffer_pool_test: all checks passed" << std::endl;
+    return 0;
+}
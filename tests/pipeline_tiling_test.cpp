@@ -0,0 +1,119 @@
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <future>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <opencv2/opencv.hpp>
+
+#include "trt_segmentation.h"
+
+// 流水线中分块与非分块图像混合的回归测试：null 后端、1 个执行上下文，
+// 先提交一张需要分块的大图再提交一张小图，两者都必须完成 (曾经因为编码阶段的分块推理
+// 等待排在后面的小图所持有的上下文而死锁)。
+
+namespace {
+
+int failures = 0;
+
+void check(bool condition, const char* test, const char* what) {
+    if (!condition) {
+        std::cerr << "FAIL " << test << ": " << what << std::endl;
+        ++failures;
+    }
+}
+
+cv::Mat make_image(int width, int height, int seed) {
+    cv::Mat image(height, width, CV_8UC3);
+    for (int y = 0; y < height; ++y) {
+        uint8_t* row = image.ptr(y);
+        for (int x = 0; x < width; ++x) {
+            row[3 * x + 0] = static_cast<uint8_t>(x * 7 + y * 3 + seed * 31);
+            row[3 * x + 1] = static_cast<uint8_t>(x * 5 + y * 11 + seed * 17);
+            row[3 * x + 2] = static_cast<uint8_t>((x ^ y) + seed * 13);
+        }
+    }
+    return image;
+}
+
+// A deadlock never returns, so the call runs on another thread and the test gives up after a timeout
+template <typename Fn>
+bool finishes_in_time(Fn fn) {
+    auto result = std::async(std::launch::async, fn);
+    if (result.wait_for(std::chrono::seconds(60)) == std::future_status::ready) {
+        return result.get();
+    }
+    std::cerr << "FAIL: timed out, the pipeline is deadlocked" << std::endl;
+    std::_Exit(1); // the stuck pipeline threads cannot be joined
+}
+
+bool mask_matches(const std::string& path, int width, int height) {
+    const cv::Mat mask = cv::imread(path, cv::IMREAD_UNCHANGED);
+    return !mask.empty() && mask.cols == width && mask.rows == height;
+}
+
+} // namespace
+
+int main() {
+    const std::filesystem::path dir = std::filesystem::temp_directory_path() / "trt_seg_pipeline_tiling_test";
+    std::filesystem::create_directories(dir);
+
+    // Larger than the 2048 x 256 model input in both directions, and well within it
+    const int large_width = 4096, large_height = 600;
+    const int small_width = 1024, small_height = 128;
+    const std::string large = (dir / "large.png").string();
+    const std::string small = (dir / "small.png").string();
+    if (!cv::imwrite(large, make_image(large_width, large_height, 1)) ||
+        !cv::imwrite(small, make_image(small_width, small_height, 2))) {
+        std::cerr << "Could not write the test images to " << dir << std::endl;
+        return 1;
+    }
+
+    TRT_SEG_HANDLE handle = create_segmentation_instance();
+    if (!handle || set_backend(handle, TRT_SEG_BACKEND_NULL) != 0 || set_context_pool_size(handle, 1) != 0 ||
+        init_engine(handle, "classes=2") != 0 || set_tiling(handle, 1, 64) != 0) {
+        std::cerr << "Could not initialize the null backend." << std::endl;
+        destroy_segmentation_instance(handle);
+        return 1;
+    }
+
+    {
+        const char* name = "batch_large_then_small";
+        const std::string large_out = (dir / "batch_large_mask.png").string();
+        const std::string small_out = (dir / "batch_small_mask.png").string();
+        const char* inputs[2] = {large.c_str(), small.c_str()};
+        const char* outputs[2] = {large_out.c_str(), small_out.c_str()};
+        int statuses[2] = {-1, -1};
+        const bool ok = finishes_in_time([&] { return run_inference_batch(handle, inputs, outputs, 2, statuses) == 0; });
+        check(ok && statuses[0] == 0 && statuses[1] == 0, name, "an item failed");
+        check(mask_matches(large_out, large_width, large_height), name, "large mask missing or wrong size");
+        check(mask_matches(small_out, small_width, small_height), name, "small mask missing or wrong size");
+    }
+
+    {
+        // Packed output goes through infer_packed instead of infer_tiled
+        const char* name = "pipeline_large_then_small_packed";
+        const std::string large_out = (dir / "pipeline_large_mask.pbm").string();
+        const std::string small_out = (dir / "pipeline_small_mask.png").string();
+        const bool ok = finishes_in_time([&] {
+            return pipeline_start(handle, 4) == 0 && pipeline_submit(handle, large.c_str(), large_out.c_str()) == 0 &&
+                   pipeline_submit(handle, small.c_str(), small_out.c_str()) == 0 && pipeline_flush(handle) == 0;
+        });
+        pipeline_stop(handle);
+        check(ok, name, "an item failed");
+        check(std::filesystem::exists(large_out), name, "large mask missing");
+        check(mask_matches(small_out, small_width, small_height), name, "small mask missing or wrong size");
+    }
+
+    destroy_segmentation_instance(handle);
+    std::filesystem::remove_all(dir);
+
+    if (failures > 0) {
+        std::cerr << failures << " check(s) failed" << std::endl;
+        return 1;
+    }
+    std::cout << "pipeline_tiling_test: all checks passed" << std::endl;
+    return 0;
+}